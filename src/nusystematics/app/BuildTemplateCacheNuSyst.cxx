@@ -0,0 +1,95 @@
+#include "systematicstools/utility/ParameterAndProviderConfigurationUtility.hh"
+#include "systematicstools/utility/md5.hh"
+
+#include "nusystematics/utility/TemplateCache.hh"
+#include "nusystematics/utility/make_instance.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <iomanip>
+#include <iostream>
+
+namespace cliopts {
+std::string fclname = "";
+std::string outputfile = "";
+} // namespace cliopts
+
+void SayUsage(char const *argv[]) {
+  std::cout << "[USAGE]: " << argv[0] << "\n" << std::endl;
+  std::cout << "\t-?|--help         : Show this message.\n"
+               "\t-c <config.fcl>   : fhicl file to read, as passed to\n"
+               "\t                    response_helper.\n"
+               "\t-o <cache.bin>    : template cache file to write.\n"
+               "\n"
+               "\tLoads the input templates of every configured provider and "
+               "writes them\n"
+               "\tto a single file, which jobs using the same provider\n"
+               "\tconfiguration load by setting TemplateCacheFile: "
+               "\"<cache.bin>\".\n"
+            << std::endl;
+}
+
+void HandleOpts(int argc, char const *argv[]) {
+  int opt = 1;
+  while (opt < argc) {
+    if ((std::string(argv[opt]) == "-?") ||
+        (std::string(argv[opt]) == "--help")) {
+      SayUsage(argv);
+      exit(0);
+    } else if (std::string(argv[opt]) == "-c") {
+      cliopts::fclname = argv[++opt];
+    } else if (std::string(argv[opt]) == "-o") {
+      cliopts::outputfile = argv[++opt];
+    } else {
+      std::cout << "[ERROR]: Unknown option: " << argv[opt] << std::endl;
+      SayUsage(argv);
+      exit(1);
+    }
+    opt++;
+  }
+}
+
+int main(int argc, char const *argv[]) {
+  HandleOpts(argc, argv);
+  if (!cliopts::fclname.size() || !cliopts::outputfile.size()) {
+    std::cout << "[ERROR]: Expected to be passed -c and -o options."
+              << std::endl;
+    SayUsage(argv);
+    exit(1);
+  }
+
+  std::unique_ptr<cet::filepath_maker> fm =
+      std::make_unique<cet::filepath_maker>();
+
+  fhicl::ParameterSet in_ps = fhicl::ParameterSet::make(cliopts::fclname, *fm);
+  fhicl::ParameterSet const &provider_ps = in_ps.get<fhicl::ParameterSet>(
+      "generated_systematic_provider_configuration");
+
+  std::vector<std::unique_ptr<nusyst::IGENIESystProvider_tool>> tools =
+      systtools::ConfigureISystProvidersFromParameterHeaders<
+          nusyst::IGENIESystProvider_tool>(provider_ps, nusyst::make_instance);
+
+  std::string config_md5 = systtools::md5(provider_ps.to_compact_string());
+  nusyst::TemplateCacheWriter writer(config_md5);
+  for (auto &prov : tools) {
+    size_t NRecords = writer.GetNRecords();
+    prov->WriteTemplateCache(writer);
+    if (writer.GetNRecords() != NRecords) {
+      std::cout << "[INFO]: Cached " << (writer.GetNRecords() - NRecords)
+                << " templates from "
+                << std::quoted(prov->GetFullyQualifiedName()) << std::endl;
+    }
+  }
+  writer.Write(cliopts::outputfile);
+
+  // Re-open the file to check that it reads back, jobs loading it only
+  // check its layout.
+  std::shared_ptr<nusyst::TemplateCache const> cache =
+      nusyst::TemplateCache::Open(cliopts::outputfile);
+  cache->VerifyChecksum();
+
+  std::cout << "Wrote " << cache->GetNRecords() << " templates ("
+            << writer.GetNBytes() << " bytes) for systematic provider "
+            << "configuration with md5: " << std::quoted(config_md5) << " to "
+            << std::quoted(cliopts::outputfile) << std::endl;
+}
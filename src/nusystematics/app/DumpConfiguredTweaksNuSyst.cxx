@@ -12,6 +12,7 @@
 #include "nusystematics/utility/enumclass2int.hh"
 #include "nusystematics/utility/KinVarUtils.hh"
 
+#include "nusystematics/utility/parallel_response_helper.hh"
 #include "nusystematics/utility/response_helper.hh"
 
 #include "fhiclcpp/ParameterSet.h"
@@ -28,9 +29,11 @@
 #include "TFile.h"
 
 #include <algorithm>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -85,13 +88,18 @@ struct TweakSummaryTree {
   std::vector<int> ntweaks;
   std::vector<std::vector<double>> tweak_branches;
   std::vector<double> paramCVResponses;
-  std::map<paramId_t, size_t> tweak_indices;
+  // Branch vectors are indexed by the response_helper parameter slot.
+  ParameterSlots slots;
+  // Whether the responses to each parameter that may be emulated were
+  // emulated for this event, rather than calculated exactly.
+  std::vector<size_t> emulated_slots;
+  std::unique_ptr<bool[]> emulated;
 
   TObjString *meta_name;
   int meta_n;
   std::vector<double> meta_tweak_values;
 
-  void AddBranches(ParamHeaderHelper const &phh) {
+  void AddBranches(response_helper const &phh) {
     
     // TH: Add branches for output weights tree
     t->Branch("Mode", &Mode, "Mode/I");
@@ -107,8 +115,7 @@ struct TweakSummaryTree {
     t->Branch("plep", &plep, "plep/F");
     t->Branch("nucleon_pdg", &nucleon_pdg, "nucleon_pdg/I");
     t->Branch("target_pdg", &target_pdg, "target_pdg/I");
-      
-    size_t vector_idx = 0;
+
     t->Branch("nu_pdg", &nu_pdg, "nu_pdg/I");
     t->Branch("e_nu_GeV", &e_nu_GeV, "e_nu_GeV/D");
     t->Branch("tgt_A", &tgt_A, "tgt_A/I");
@@ -128,13 +135,10 @@ struct TweakSummaryTree {
     t->Branch("fsi_pdgs", "vector<int>", &fsi_pdgs);
     t->Branch("fsi_codes", "vector<int>", &fsi_codes);
 
-    for (paramId_t pid : phh.GetParameters()) { // Need to size vectors first so
-                                                // that realloc doesn't upset
-                                                // the TBranches
-      SystParamHeader const &hdr = phh.GetHeader(pid);
-      if (hdr.isResponselessParam) {
-        continue;
-      }
+    // Need to size vectors first so that realloc doesn't upset the TBranches
+    slots = phh.GetParameterSlots();
+    for (size_t slot = 0; slot < slots.size(); ++slot) {
+      SystParamHeader const &hdr = phh.GetHeader(slots.GetParameterId(slot));
 
       if (hdr.isCorrection) {
         ntweaks.emplace_back(1);
@@ -143,12 +147,10 @@ struct TweakSummaryTree {
       }
       tweak_branches.emplace_back();
       std::fill_n(std::back_inserter(tweak_branches.back()), ntweaks.back(), 1);
-      tweak_indices[pid] = vector_idx;
 
       if (ntweaks.back() > int(meta_tweak_values.size())) {
         meta_tweak_values.resize(ntweaks.back());
       }
-      vector_idx++;
     }
     std::fill_n(std::back_inserter(paramCVResponses), ntweaks.size(), 1);
 
@@ -158,12 +160,8 @@ struct TweakSummaryTree {
     m->Branch("tweakvalues", meta_tweak_values.data(),
               "tweakvalues[ntweaks]/D");
 
-    for (paramId_t pid : phh.GetParameters()) {
-      SystParamHeader const &hdr = phh.GetHeader(pid);
-      if (hdr.isResponselessParam) {
-        continue;
-      }
-      size_t idx = tweak_indices[pid];
+    for (size_t idx = 0; idx < slots.size(); ++idx) {
+      SystParamHeader const &hdr = phh.GetHeader(slots.GetParameterId(idx));
 
       std::stringstream ss_ntwk("");
       ss_ntwk << "ntweaks_" << hdr.prettyName;
@@ -192,57 +190,96 @@ struct TweakSummaryTree {
 
       m->Fill();
     }
+
+    for (paramId_t pid : phh.GetEmulatedParameters()) {
+      emulated_slots.push_back(slots.GetSlot(pid));
+    }
+    emulated = std::make_unique<bool[]>(emulated_slots.size());
+    for (size_t e_it = 0; e_it < emulated_slots.size(); ++e_it) {
+      std::string bname =
+          "emulated_" +
+          phh.GetHeader(slots.GetParameterId(emulated_slots[e_it])).prettyName;
+      t->Branch(bname.c_str(), &emulated[e_it], (bname + "/O").c_str());
+    }
   }
 
   // Clear weight vectors
   void Clear() {
     std::fill_n(ntweaks.begin(), ntweaks.size(), 0);
     std::fill_n(paramCVResponses.begin(), ntweaks.size(), 1);
+    std::fill_n(emulated.get(), emulated_slots.size(), false);
+  }
+  void SetUnhandled(size_t slot) {
+    ntweaks[slot] = 7;
+    std::fill_n(tweak_branches[slot].begin(), ntweaks[slot], 1);
+    paramCVResponses[slot] = 1;
+  }
+  void SetResponses(size_t slot, paramId_t pid, double const *responses,
+                    size_t NResponses) {
+    if (tweak_branches[slot].size() != NResponses) {
+      throw unexpected_number_of_responses()
+          << "[ERROR]: Expected " << ntweaks[slot]
+          << " responses from parameter " << pid << ", but found "
+          << NResponses;
+    }
+    ntweaks[slot] = NResponses;
+    std::copy_n(responses, NResponses, tweak_branches[slot].begin());
   }
   void Add(event_unit_response_t const &eu) {
-    for (std::pair<paramId_t, size_t> idx_id : tweak_indices) {
-      size_t resp_idx = GetParamContainerIndex(eu, idx_id.first);
-      if (resp_idx != systtools::kParamUnhandled<size_t>) {
-        ParamResponses const &resp = eu[resp_idx];
-        if (tweak_branches[idx_id.second].size() != resp.responses.size()) {
-          throw unexpected_number_of_responses()
-              << "[ERROR]: Expected " << ntweaks[idx_id.second]
-              << " responses from parameter " << resp.pid << ", but found "
-              << resp.responses.size();
-        }
-        ntweaks[idx_id.second] = resp.responses.size();
-        std::copy_n(resp.responses.begin(), ntweaks[idx_id.second],
-                    tweak_branches[idx_id.second].begin());
-      } else {
-        ntweaks[idx_id.second] = 7;
-        std::fill_n(tweak_branches[idx_id.second].begin(),
-                    ntweaks[idx_id.second], 1);
+    for (size_t slot = 0; slot < slots.size(); ++slot) {
+      SetUnhandled(slot);
+    }
+    for (ParamResponses const &resp : eu) {
+      size_t slot = slots.GetSlot(resp.pid);
+      if (slot != systtools::kParamUnhandled<size_t>) {
+        SetResponses(slot, resp.pid, resp.responses.data(),
+                     resp.responses.size());
       }
     }
   }
   void Add(event_unit_response_w_cv_t const &eu) {
-    for (std::pair<paramId_t, size_t> idx_id : tweak_indices) {
-      size_t resp_idx = GetParamContainerIndex(eu, idx_id.first);
-      if (resp_idx != systtools::kParamUnhandled<size_t>) {
-        VarAndCVResponse const &prcw = eu[resp_idx];
-        if (tweak_branches[idx_id.second].size() != prcw.responses.size()) {
-          throw unexpected_number_of_responses()
-              << "[ERROR]: Expected " << ntweaks[idx_id.second]
-              << " responses from parameter " << prcw.pid << ", but found "
-              << prcw.responses.size();
-        }
-        ntweaks[idx_id.second] = prcw.responses.size();
-        std::copy_n(prcw.responses.begin(), ntweaks[idx_id.second],
-                    tweak_branches[idx_id.second].begin());
-        paramCVResponses[idx_id.second] = prcw.CV_response;
+    for (size_t slot = 0; slot < slots.size(); ++slot) {
+      SetUnhandled(slot);
+    }
+    for (VarAndCVResponse const &prcw : eu) {
+      size_t slot = slots.GetSlot(prcw.pid);
+      if (slot != systtools::kParamUnhandled<size_t>) {
+        SetResponses(slot, prcw.pid, prcw.responses.data(),
+                     prcw.responses.size());
+        paramCVResponses[slot] = prcw.CV_response;
+      }
+    }
+  }
 
+  /// Reads the responses after EventResponseArena::SeparateCVResponses. The
+  /// arena must have been made by the response_helper passed to AddBranches,
+  /// so that its slots are the tree's slots.
+  void Add(EventResponseArena const &arena) {
+    if (arena.GetNSlots() != slots.size()) {
+      throw unexpected_number_of_responses()
+          << "[ERROR]: Expected an EventResponseArena with " << slots.size()
+          << " slots, but found " << arena.GetNSlots();
+    }
+    for (size_t slot = 0; slot < slots.size(); ++slot) {
+      if (arena.IsFilled(slot)) {
+        SetResponses(slot, slots.GetParameterId(slot),
+                     arena.GetResponses(slot), arena.GetNVariations(slot));
+        paramCVResponses[slot] = arena.GetCVResponse(slot);
       } else {
-        ntweaks[idx_id.second] = 7;
-        std::fill_n(tweak_branches[idx_id.second].begin(),
-                    ntweaks[idx_id.second], 1);
-        paramCVResponses[idx_id.second] = 1;
+        SetUnhandled(slot);
       }
     }
+    for (size_t e_it = 0; e_it < emulated_slots.size(); ++e_it) {
+      emulated[e_it] = arena.IsEmulated(emulated_slots[e_it]);
+    }
+  }
+
+  /// Reads the emulation flags of the ev-th event of a block made by the
+  /// response_helper passed to AddBranches.
+  void SetEmulated(EventResponseBlock const &block, size_t ev) {
+    for (size_t e_it = 0; e_it < emulated_slots.size(); ++e_it) {
+      emulated[e_it] = block.IsEmulated(emulated_slots[e_it], ev);
+    }
   }
 
   void Fill() { t->Fill(); }
@@ -253,10 +290,15 @@ std::string fclname = "";
 std::string genie_input = "";
 std::string genie_branch_name = "gmcrec";
 std::string outputfile = "";
+std::string profile_json = "";
+std::string trace_json = "";
 std::string envvar = "FHICL_FILE_PATH";
 std::string fhicl_key = "generated_systematic_provider_configuration";
 size_t NMax = std::numeric_limits<size_t>::max();
 size_t NSkip = 0;
+size_t NThreads = 1;
+size_t BlockSize = 1000;
+bool VariationMajor = false;
 #ifndef NO_ART
 int lookup_policy = 1;
 #endif
@@ -276,6 +318,23 @@ void SayUsage(char const *argv[]) {
                "\t-N <NMax>        : Maximum number of events to process.\n"
                "\t-s <NSkip>       : Number of events to skip.\n"
                "\t-o <out.root>    : File to write validation canvases to.\n"
+               "\t-t <NThreads>    : Number of worker threads to calculate\n"
+               "\t                   responses with, 1 by default.\n"
+               "\t-B <BlockSize>   : Number of events to buffer per parallel\n"
+               "\t                   or batch block, 1000 by default.\n"
+               "\t-V               : Calculate responses in batches of -B\n"
+               "\t                   events, looping over parameter variations\n"
+               "\t                   outside of events. Reduces the number of\n"
+               "\t                   GENIE reweight engine reconfigurations\n"
+               "\t                   when UseFullHERG is false. Not\n"
+               "\t                   compatible with -t.\n"
+               "\t-P <profile.json>: Write the response latency profile to\n"
+               "\t                   a JSON file, requires ProfileRate,\n"
+               "\t                   Profile or PerfCounters to be set in the\n"
+               "\t                   configuration.\n"
+               "\t-T <trace.json>  : Record a timeline of event reading,\n"
+               "\t                   response calculation and output, and\n"
+               "\t                   write it as Chrome trace JSON.\n"
             << std::endl;
 }
 
@@ -300,6 +359,16 @@ void HandleOpts(int argc, char const *argv[]) {
       cliopts::NSkip = str2T<size_t>(argv[++opt]);
     } else if (std::string(argv[opt]) == "-o") {
       cliopts::outputfile = argv[++opt];
+    } else if (std::string(argv[opt]) == "-t") {
+      cliopts::NThreads = str2T<size_t>(argv[++opt]);
+    } else if (std::string(argv[opt]) == "-B") {
+      cliopts::BlockSize = str2T<size_t>(argv[++opt]);
+    } else if (std::string(argv[opt]) == "-V") {
+      cliopts::VariationMajor = true;
+    } else if (std::string(argv[opt]) == "-P") {
+      cliopts::profile_json = argv[++opt];
+    } else if (std::string(argv[opt]) == "-T") {
+      cliopts::trace_json = argv[++opt];
     } else {
       std::cout << "[ERROR]: Unknown option: " << argv[opt] << std::endl;
       SayUsage(argv);
@@ -309,8 +378,114 @@ void HandleOpts(int argc, char const *argv[]) {
   }
 }
 
+void FillEventSummary(TweakSummaryTree &tst,
+                      genie::EventRecord const &GenieGHep) {
+  genie::GHepParticle *FSLep = GenieGHep.FinalStatePrimaryLepton();
+  genie::GHepParticle *ISLep = GenieGHep.Probe();
+  genie::GHepParticle *nucleon = GenieGHep.HitNucleon();
+  
+  TLorentzVector FSLepP4 = *FSLep->P4();
+  TLorentzVector ISLepP4 = *ISLep->P4();
+  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
+
+  tst.Mode = genie::utils::ghep::NeutReactionCode(&GenieGHep);
+  tst.Emiss = GetEmiss(GenieGHep, false);
+  tst.Emiss_preFSI = GetEmiss(GenieGHep, true);
+  tst.pmiss = GetPmiss(GenieGHep, false);
+  tst.pmiss_preFSI = GetPmiss(GenieGHep, true);
+
+  if (GenieGHep.HitNucleon() == NULL){
+    tst.Emiss_GENIE = -999;
+  }
+  else {
+    tst.Emiss_GENIE = GenieGHep.HitNucleon()->RemovalEnergy();
+  }
+
+  tst.q0 = emTransfer.E();
+  tst.Q2 = -emTransfer.Mag2();
+  tst.q3 = emTransfer.Vect().Mag();
+  tst.Enu_true = ISLepP4.E();
+  tst.plep = FSLepP4.Vect().Mag();
+  if (nucleon == NULL) {tst.nucleon_pdg = -999;}
+  else{tst.nucleon_pdg = nucleon->Pdg();}
+  tst.target_pdg = GenieGHep.TargetNucleus()->Pdg();
+
+  // loop over particles
+  int ip=-1;
+  GHepParticle * p = 0;
+  TIter event_iter(&GenieGHep);
+
+  std::vector<int> fsi_pdgs;
+  std::vector<int> fsi_codes;
+
+  while ( (p = dynamic_cast<GHepParticle *>(event_iter.Next())) ) {
+    ip++;
+
+    // Skip particles not rescattered by the actual hadron transport code
+    int  pdgc       = p->Pdg();
+    bool is_pion    = pdg::IsPion   (pdgc);
+    bool is_nucleon = pdg::IsNucleon(pdgc);
+    bool is_kaon = pdg::IsKaon( pdgc );
+    if(!is_pion && !is_nucleon && !is_kaon){
+      continue;
+    }
+
+    // Skip particles with code other than 'hadron in the nucleus'
+    GHepStatus_t ist  = p->Status();
+    if(ist != kIStHadronInTheNucleus){
+      continue;
+    }
+
+    // Kaon FSIs can't currently be reweighted. Just update (A, Z) based on
+    // the particle's daughters and move on.
+    if ( is_kaon ) {
+      continue;
+    }
+
+    int fsi_code = p->RescatterCode();
+    fsi_pdgs.push_back(pdgc);
+    fsi_codes.push_back(fsi_code);
+
+  } // END particle loop
+  tst.fsi_pdgs = fsi_pdgs;
+  tst.fsi_codes = fsi_codes;
+}
+
 typedef IGENIESystProvider_tool SystProv;
 
+void WriteTrace() {
+  ResponseTracer &tracer = ResponseTracer::Get();
+  if (!tracer.IsEnabled()) {
+    return;
+  }
+  if (!cliopts::trace_json.size()) {
+    std::cout << "[WARN]: Tracing was enabled in the configuration, but no "
+                 "trace file was passed with -T."
+              << std::endl;
+    return;
+  }
+  std::ofstream ofs(cliopts::trace_json);
+  tracer.WriteJSON(ofs);
+}
+
+void WriteProfile(ResponseProfiler const *profiler, TDirectory *dir) {
+  if (!profiler) {
+    if (cliopts::profile_json.size()) {
+      std::cout << "[WARN]: -P was passed, but profiling was not enabled in "
+                   "the configuration."
+                << std::endl;
+    }
+    return;
+  }
+  std::cout << "[PROFILE]: Final response latencies:" << std::endl;
+  profiler->Print(std::cout);
+  profiler->WriteTree(dir);
+  if (cliopts::profile_json.size()) {
+    std::ofstream ofs(cliopts::profile_json);
+    profiler->WriteJSON(ofs);
+  }
+}
+
 fhicl::ParameterSet ReadParameterSet(char const *[]) {
   // TODO
   std::unique_ptr<cet::filepath_maker> fm = std::make_unique<cet::filepath_maker>();
@@ -330,7 +505,44 @@ int main(int argc, char const *argv[]) {
     return 1;
   }
 
-  response_helper phh(cliopts::fclname);
+  if (!cliopts::NThreads) {
+    std::cout << "[ERROR]: Expected -t to be passed a positive number."
+              << std::endl;
+    SayUsage(argv);
+    return 1;
+  }
+
+  if (cliopts::VariationMajor && (cliopts::NThreads > 1)) {
+    std::cout << "[ERROR]: -V cannot be used with -t." << std::endl;
+    SayUsage(argv);
+    return 1;
+  }
+
+  if (cliopts::trace_json.size()) {
+    ResponseTracer::Get().Enable();
+  }
+  ResponseTracer &tracer = ResponseTracer::Get();
+  ResponseTracer::name_id_t const GetEntryTraceName =
+      tracer.Intern("TChain::GetEntry");
+  ResponseTracer::name_id_t const ReadEventTraceName =
+      tracer.Intern("ReadEvent");
+  ResponseTracer::name_id_t const CalculateTraceName =
+      tracer.Intern("CalculateResponses");
+  ResponseTracer::name_id_t const SummaryTraceName =
+      tracer.Intern("FillEventSummary");
+  ResponseTracer::name_id_t const TreeFillTraceName =
+      tracer.Intern("TTree::Fill");
+
+  // Only one of the helpers is instantiated, as each instantiates all of the
+  // configured providers.
+  std::unique_ptr<response_helper> phh;
+  std::unique_ptr<parallel_response_helper> pphh;
+  if (cliopts::NThreads > 1) {
+    pphh = std::make_unique<parallel_response_helper>(cliopts::fclname,
+                                                      cliopts::NThreads);
+  } else {
+    phh = std::make_unique<response_helper>(cliopts::fclname);
+  }
 
   TChain *gevs = new TChain("gtree");
   if (!gevs->Add(cliopts::genie_input.c_str())) {
@@ -361,7 +573,7 @@ int main(int argc, char const *argv[]) {
   }
 
   TweakSummaryTree tst(cliopts::outputfile.c_str());
-  tst.AddBranches(phh);
+  tst.AddBranches(pphh ? pphh->GetHeaderHelper() : *phh);
 
   genie::Messenger::Instance()->SetPrioritiesFromXmlFile(
       "Messenger_whisper.xml");
@@ -369,97 +581,114 @@ int main(int argc, char const *argv[]) {
   size_t NToRead = std::min(NEvs, cliopts::NMax);
   size_t NToShout = NToRead / 20;
   NToShout = NToShout ? NToShout : 1;
-  for (size_t ev_it = cliopts::NSkip; ev_it < NToRead; ++ev_it) {
-    gevs->GetEntry(ev_it);
-    genie::EventRecord const &GenieGHep = *GenieNtpl->event;
-
-    genie::GHepParticle *FSLep = GenieGHep.FinalStatePrimaryLepton();
-    genie::GHepParticle *ISLep = GenieGHep.Probe();
-    genie::GHepParticle *nucleon = GenieGHep.HitNucleon();
-    
-    TLorentzVector FSLepP4 = *FSLep->P4();
-    TLorentzVector ISLepP4 = *ISLep->P4();
-    TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-
-    tst.Mode = genie::utils::ghep::NeutReactionCode(&GenieGHep);
-    tst.Emiss = GetEmiss(GenieGHep, false);
-    tst.Emiss_preFSI = GetEmiss(GenieGHep, true);
-    tst.pmiss = GetPmiss(GenieGHep, false);
-    tst.pmiss_preFSI = GetPmiss(GenieGHep, true);
-
-    if (GenieGHep.HitNucleon() == NULL){
-      tst.Emiss_GENIE = -999;
+  auto ShoutProgress = [&](size_t ev_it, genie::EventRecord const &GenieGHep) {
+    if (!(ev_it % NToShout)) {
+      std::cout << (ev_it ? "\r" : "") << "Event #" << ev_it << "/" << NToRead
+                << ", Interaction: " << GenieGHep.Summary()->AsString()
+                << std::flush;
     }
-    else {
-      tst.Emiss_GENIE = GenieGHep.HitNucleon()->RemovalEnergy();
+  };
+
+  if (pphh || cliopts::VariationMajor) {
+    // Events are copied out of the ntuple in blocks so that the workers can
+    // process them concurrently, or so that providers can process them as a
+    // batch. The output tree is filled in input order.
+    EventResponseBlock response_block;
+    if (phh) {
+      response_block = phh->MakeEventResponseBlock();
     }
 
-    tst.q0 = emTransfer.E();
-    tst.Q2 = -emTransfer.Mag2();
-    tst.q3 = emTransfer.Vect().Mag();
-    tst.Enu_true = ISLepP4.E();
-    tst.plep = FSLepP4.Vect().Mag();
-    if (nucleon == NULL) {tst.nucleon_pdg = -999;}
-    else{tst.nucleon_pdg = nucleon->Pdg();}
-    tst.target_pdg = GenieGHep.TargetNucleus()->Pdg();
-
-    // loop over particles
-    int ip=-1;
-    GHepParticle * p = 0;
-    TIter event_iter(&GenieGHep);
-
-    std::vector<int> fsi_pdgs;
-    std::vector<int> fsi_codes;
-
-    while ( (p = dynamic_cast<GHepParticle *>(event_iter.Next())) ) {
-      ip++;
-
-      // Skip particles not rescattered by the actual hadron transport code
-      int  pdgc       = p->Pdg();
-      bool is_pion    = pdg::IsPion   (pdgc);
-      bool is_nucleon = pdg::IsNucleon(pdgc);
-      bool is_kaon = pdg::IsKaon( pdgc );
-      if(!is_pion && !is_nucleon && !is_kaon){
-        continue;
+    std::vector<std::unique_ptr<genie::EventRecord>> block;
+    for (size_t ev_it = cliopts::NSkip; ev_it < NToRead;) {
+      size_t block_start = ev_it;
+      block.clear();
+      for (; (ev_it < NToRead) && (block.size() < cliopts::BlockSize);
+           ++ev_it) {
+        TraceSpan read_span(ReadEventTraceName, int32_t(ev_it));
+        {
+          TraceSpan span(GetEntryTraceName);
+          gevs->GetEntry(ev_it);
+        }
+        block.emplace_back(
+            std::make_unique<genie::EventRecord>(*GenieNtpl->event));
+        // TH: Very important to clear this object to avoid memory issues!
+        GenieNtpl->Clear();
       }
 
-      // Skip particles with code other than 'hadron in the nucleus'
-      GHepStatus_t ist  = p->Status();
-      if(ist != kIStHadronInTheNucleus){
-        continue;
+      std::vector<event_unit_response_w_cv_t> resps;
+      {
+        TraceSpan span(CalculateTraceName, int32_t(block.size()));
+        resps = pphh ? pphh->GetEventVariationAndCVResponses(block)
+                     : phh->GetEventVariationAndCVResponses(block,
+                                                            response_block);
       }
 
-      // Kaon FSIs can't currently be reweighted. Just update (A, Z) based on
-      // the particle's daughters and move on.
-      if ( is_kaon ) {
-        continue;
+      for (size_t b_it = 0; b_it < block.size(); ++b_it) {
+        {
+          TraceSpan span(SummaryTraceName);
+          FillEventSummary(tst, *block[b_it]);
+        }
+        ShoutProgress(block_start + b_it, *block[b_it]);
+
+        tst.Clear();
+        tst.Add(resps[b_it]);
+        if (phh) {
+          tst.SetEmulated(response_block, b_it);
+        }
+        {
+          TraceSpan span(TreeFillTraceName);
+          tst.Fill();
+        }
       }
+    }
+    std::cout << std::endl;
+    if (pphh) {
+      pphh->WriteDiagnostics(tst.f);
+      WriteProfile(pphh->GetMergedProfiler().get(), tst.f);
+    } else {
+      phh->WriteDiagnostics(tst.f);
+      WriteProfile(phh->GetProfiler(), tst.f);
+    }
+    WriteTrace();
+    return 0;
+  }
 
-      int fsi_code = p->RescatterCode();
-      fsi_pdgs.push_back(pdgc);
-      fsi_codes.push_back(fsi_code);
+  // Sized once, reused for every event.
+  EventResponseArena arena = phh->MakeEventResponseArena();
 
-    } // END particle loop
-    tst.fsi_pdgs = fsi_pdgs;
-    tst.fsi_codes = fsi_codes;
+  for (size_t ev_it = cliopts::NSkip; ev_it < NToRead; ++ev_it) {
+    {
+      TraceSpan span(GetEntryTraceName, int32_t(ev_it));
+      gevs->GetEntry(ev_it);
+    }
+    genie::EventRecord const &GenieGHep = *GenieNtpl->event;
 
-    if (!(ev_it % NToShout)) {
-      std::cout << (ev_it ? "\r" : "") << "Event #" << ev_it << "/" << NToRead
-                << ", Interaction: " << GenieGHep.Summary()->AsString()
-                << std::flush;
+    {
+      TraceSpan span(SummaryTraceName);
+      FillEventSummary(tst, GenieGHep);
     }
+    ShoutProgress(ev_it, GenieGHep);
 
     tst.Clear();
 
     // Calcuate weights
-    event_unit_response_w_cv_t resp = phh.GetEventVariationAndCVResponse(GenieGHep);
+    {
+      TraceSpan span(CalculateTraceName);
+      phh->FillEventVariationAndCVResponses(GenieGHep, arena);
+    }
 
-    tst.Add(resp);
-    tst.Fill();
+    tst.Add(arena);
+    {
+      TraceSpan span(TreeFillTraceName);
+      tst.Fill();
+    }
     
     // TH: Very important to clear this object to avoid memory issues!
     GenieNtpl->Clear();
 
   }
   std::cout << std::endl;
+  phh->WriteDiagnostics(tst.f);
+  WriteProfile(phh->GetProfiler(), tst.f);
+  WriteTrace();
 }
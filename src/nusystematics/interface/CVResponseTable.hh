@@ -0,0 +1,150 @@
+#pragma once
+
+#include "nusystematics/interface/ParameterSlots.hh"
+
+#include "systematicstools/interface/SystMetaData.hh"
+#include "systematicstools/interface/types.hh"
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(invalid_CV_response_table);
+
+/// How the CV response is separated from the variation responses of a
+/// parameter, resolved from its header once at setup.
+struct ParamCVInfo {
+  enum class normalisation_t {
+    /// No CV value: the CV response is the default and the responses are
+    /// left untouched.
+    kNone,
+    /// Weight responses are divided by the CV response.
+    kDivide,
+    /// Non-weight responses have the CV response subtracted.
+    kSubtract,
+    /// The single correction response becomes the CV response.
+    kCorrection
+  };
+
+  constexpr static size_t kNoCVVariation = std::numeric_limits<size_t>::max();
+
+  systtools::paramId_t pid;
+  /// Number of responses expected from the provider.
+  size_t NVariations;
+  /// Index of the variation at the CV, or kNoCVVariation.
+  size_t CVVariationIndex;
+  bool IsWeight;
+  bool IsCorrection;
+  normalisation_t Normalisation;
+  /// CV response used when no variation is at the CV.
+  double DefaultCVResponse;
+};
+
+inline ParamCVInfo BuildParamCVInfo(systtools::SystParamHeader const &hdr) {
+  if (hdr.isCorrection && hdr.paramVariations.size()) {
+    throw invalid_CV_response_table()
+        << "[ERROR]: Parameter: " << hdr.prettyName
+        << " is a correction but has non-zero parameter variations ("
+        << hdr.paramVariations.size() << ").";
+  }
+
+  ParamCVInfo info;
+  info.pid = hdr.systParamId;
+  info.NVariations = hdr.isCorrection ? 1 : hdr.paramVariations.size();
+  info.CVVariationIndex = ParamCVInfo::kNoCVVariation;
+  info.IsWeight = hdr.isWeightSystematicVariation;
+  info.IsCorrection = hdr.isCorrection;
+  info.DefaultCVResponse = info.IsWeight ? 1 : 0;
+
+  if (hdr.centralParamValue == systtools::kDefaultDouble) {
+    info.Normalisation = ParamCVInfo::normalisation_t::kNone;
+  } else if (hdr.isCorrection) {
+    info.Normalisation = ParamCVInfo::normalisation_t::kCorrection;
+  } else {
+    info.Normalisation = info.IsWeight
+                             ? ParamCVInfo::normalisation_t::kDivide
+                             : ParamCVInfo::normalisation_t::kSubtract;
+    for (size_t v_it = 0; v_it < hdr.paramVariations.size(); ++v_it) {
+      if (std::fabs(hdr.centralParamValue - hdr.paramVariations[v_it]) <=
+          std::numeric_limits<float>::epsilon()) {
+        info.CVVariationIndex = v_it;
+        break;
+      }
+    }
+  }
+  return info;
+}
+
+/// Normalises the info.NVariations responses in resp to the CV response
+/// and returns the CV response.
+inline double SeparateCVResponse(ParamCVInfo const &info, double *resp) {
+  switch (info.Normalisation) {
+  case ParamCVInfo::normalisation_t::kNone: {
+    return info.DefaultCVResponse;
+  }
+  case ParamCVInfo::normalisation_t::kCorrection: {
+    double CVResp = resp[0];
+    resp[0] = 1;
+    return CVResp;
+  }
+  case ParamCVInfo::normalisation_t::kDivide: {
+    if (info.CVVariationIndex == ParamCVInfo::kNoCVVariation) {
+      return info.DefaultCVResponse;
+    }
+    double CVResp = resp[info.CVVariationIndex];
+    for (size_t v_it = 0; v_it < info.NVariations; ++v_it) {
+      resp[v_it] /= CVResp;
+    }
+    return CVResp;
+  }
+  case ParamCVInfo::normalisation_t::kSubtract: {
+    if (info.CVVariationIndex == ParamCVInfo::kNoCVVariation) {
+      return info.DefaultCVResponse;
+    }
+    double CVResp = resp[info.CVVariationIndex];
+    for (size_t v_it = 0; v_it < info.NVariations; ++v_it) {
+      resp[v_it] -= CVResp;
+    }
+    return CVResp;
+  }
+  }
+  return info.DefaultCVResponse;
+}
+
+/// ParamCVInfo for a set of parameters, indexed densely by parameter id.
+class CVResponseTable {
+  ParameterSlots Indices;
+  std::vector<ParamCVInfo> Infos;
+
+public:
+  CVResponseTable() {}
+  explicit CVResponseTable(systtools::SystMetaData const &md) {
+    for (systtools::SystParamHeader const &hdr : md) {
+      AddParameter(hdr);
+    }
+  }
+
+  /// Responseless parameters do not get an entry.
+  void AddParameter(systtools::SystParamHeader const &hdr) {
+    if (hdr.isResponselessParam) {
+      return;
+    }
+    ParamCVInfo info = BuildParamCVInfo(hdr);
+    Indices.Add(hdr.systParamId);
+    Infos.push_back(info);
+  }
+
+  size_t size() const { return Infos.size(); }
+
+  /// Returns systtools::kParamUnhandled<size_t> for unknown parameters.
+  size_t GetIndex(systtools::paramId_t pid) const {
+    return Indices.GetSlot(pid);
+  }
+  ParamCVInfo const &GetInfo(size_t idx) const { return Infos[idx]; }
+};
+
+} // namespace nusyst
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "nusystematics/utility/enumclass2int.hh"
+#include "nusystematics/utility/simbUtility.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+
+namespace nusyst {
+
+/// Describes the events that a provider can respond to in terms of the
+/// interaction mode, the weak current and the neutrino flavour.
+///
+/// Outside of the described events, the provider response must be exactly
+/// either an empty response or ISystProviderTool::GetDefaultEventResponse,
+/// so that callers can skip it without changing the result.
+class EventApplicability {
+public:
+  enum class outside_response_t { kEmpty, kDefault };
+
+  enum current_t { kCC = 0, kNC, kOtherCurrent, NCurrents };
+  enum flavour_t {
+    kNue = 0,
+    kNuebar,
+    kNumu,
+    kNumubar,
+    kNutau,
+    kNutaubar,
+    kOtherFlavour,
+    NFlavours
+  };
+  /// simb_mode_copy::kUnknownInteraction to simb_mode_copy::kWeakMix
+  constexpr static size_t NModes = 15;
+
+  static size_t ModeIndex(simb_mode_copy mode) { return e2i(mode) + 1; }
+  static size_t CurrentIndex(bool IsCC, bool IsNC) {
+    return IsCC ? kCC : (IsNC ? kNC : kOtherCurrent);
+  }
+  static size_t FlavourIndex(int nu_pdg) {
+    switch (std::abs(nu_pdg)) {
+    case 12: {
+      return (nu_pdg > 0) ? kNue : kNuebar;
+    }
+    case 14: {
+      return (nu_pdg > 0) ? kNumu : kNumubar;
+    }
+    case 16: {
+      return (nu_pdg > 0) ? kNutau : kNutaubar;
+    }
+    default: { return kOtherFlavour; }
+    }
+  }
+
+private:
+  uint32_t ModeMask;
+  uint32_t CurrentMask;
+  uint32_t FlavourMask;
+  outside_response_t OutsideResponse;
+
+  constexpr static uint32_t AllBits(size_t N) { return (uint32_t(1) << N) - 1; }
+
+public:
+  /// By default, a provider is assumed to respond to every event.
+  EventApplicability()
+      : ModeMask(AllBits(NModes)), CurrentMask(AllBits(NCurrents)),
+        FlavourMask(AllBits(NFlavours)),
+        OutsideResponse(outside_response_t::kEmpty) {}
+
+  EventApplicability(std::initializer_list<simb_mode_copy> modes,
+                     std::initializer_list<current_t> currents,
+                     outside_response_t outside)
+      : EventApplicability() {
+    OutsideResponse = outside;
+    SetModes(modes);
+    SetCurrents(currents);
+  }
+
+  EventApplicability &SetModes(std::initializer_list<simb_mode_copy> modes) {
+    ModeMask = 0;
+    for (simb_mode_copy m : modes) {
+      ModeMask |= (uint32_t(1) << ModeIndex(m));
+    }
+    return *this;
+  }
+  /// Excludes individual modes from the currently applicable set.
+  EventApplicability &
+  ExcludeModes(std::initializer_list<simb_mode_copy> modes) {
+    for (simb_mode_copy m : modes) {
+      ModeMask &= ~(uint32_t(1) << ModeIndex(m));
+    }
+    return *this;
+  }
+  EventApplicability &SetCurrents(std::initializer_list<current_t> currents) {
+    CurrentMask = 0;
+    for (current_t c : currents) {
+      CurrentMask |= (uint32_t(1) << c);
+    }
+    return *this;
+  }
+  EventApplicability &SetFlavours(std::initializer_list<flavour_t> flavours) {
+    FlavourMask = 0;
+    for (flavour_t f : flavours) {
+      FlavourMask |= (uint32_t(1) << f);
+    }
+    return *this;
+  }
+  EventApplicability &SetOutsideResponse(outside_response_t outside) {
+    OutsideResponse = outside;
+    return *this;
+  }
+
+  outside_response_t GetOutsideResponse() const { return OutsideResponse; }
+
+  bool AppliesToAll() const {
+    return (ModeMask == AllBits(NModes)) &&
+           (CurrentMask == AllBits(NCurrents)) &&
+           (FlavourMask == AllBits(NFlavours));
+  }
+
+  /// Arguments are the indices returned by ModeIndex, CurrentIndex and
+  /// FlavourIndex.
+  bool Applies(size_t mode_idx, size_t current_idx, size_t flavour_idx) const {
+    return ((ModeMask >> mode_idx) & 1) && ((CurrentMask >> current_idx) & 1) &&
+           ((FlavourMask >> flavour_idx) & 1);
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "nusystematics/interface/CVResponseTable.hh"
+#include "nusystematics/interface/ParameterSlots.hh"
+
+#include "systematicstools/interface/SystMetaData.hh"
+#include "systematicstools/interface/types.hh"
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(invalid_response_arena);
+
+/// Preallocated storage for the responses of all configured parameters to a
+/// single event.
+///
+/// Storage is sized once from the parameter headers and reused for every
+/// event: Reset only forgets which parameters were filled, and providers
+/// write responses directly into the slot returned by Open, so that the
+/// steady-state response calculation does not touch the heap.
+class EventResponseArena {
+
+  ParameterSlots Slots;
+  std::vector<size_t> Offsets;
+
+  // Also used to separate the CV response, see SeparateCVResponses.
+  std::vector<ParamCVInfo> CVInfos;
+
+  std::vector<double> Data;
+  std::vector<double> CVResponses;
+
+  std::vector<size_t> FilledSlots;
+  std::vector<uint8_t> Filled;
+  std::vector<uint8_t> Emulated;
+
+public:
+  EventResponseArena() {}
+  explicit EventResponseArena(systtools::SystMetaData const &md) {
+    for (systtools::SystParamHeader const &hdr : md) {
+      AddParameter(hdr);
+    }
+  }
+
+  /// Responseless parameters do not get a slot in the arena.
+  void AddParameter(systtools::SystParamHeader const &hdr) {
+    if (hdr.isResponselessParam) {
+      return;
+    }
+    ParamCVInfo info = BuildParamCVInfo(hdr);
+    Slots.Add(hdr.systParamId);
+    CVInfos.push_back(info);
+    Offsets.push_back(Data.size());
+    Data.resize(Data.size() + CVInfos.back().NVariations);
+
+    CVResponses.push_back(CVInfos.back().DefaultCVResponse);
+    Filled.push_back(0);
+    Emulated.push_back(0);
+    FilledSlots.reserve(Slots.size());
+  }
+
+  /// Slots are assigned in the order that parameters are added, so an arena
+  /// built from response_helper::GetParameterSlots shares its slots.
+  ParameterSlots const &GetParameterSlots() const { return Slots; }
+  size_t GetNSlots() const { return Slots.size(); }
+
+  /// Returns systtools::kParamUnhandled<size_t> for unknown parameters.
+  size_t GetSlot(systtools::paramId_t pid) const { return Slots.GetSlot(pid); }
+  systtools::paramId_t GetParameterId(size_t slot) const {
+    return Slots.GetParameterId(slot);
+  }
+  size_t GetNVariations(size_t slot) const {
+    return CVInfos[slot].NVariations;
+  }
+  ParamCVInfo const &GetCVInfo(size_t slot) const { return CVInfos[slot]; }
+
+  /// Forgets the responses of the previous event.
+  void Reset() {
+    for (size_t slot : FilledSlots) {
+      Filled[slot] = 0;
+      Emulated[slot] = 0;
+    }
+    FilledSlots.clear();
+  }
+
+  /// Marks slot as filled for this event and returns the GetNVariations(slot)
+  /// responses for the caller to write.
+  double *Open(size_t slot) {
+    if (Filled[slot]) {
+      throw invalid_response_arena()
+          << "[ERROR]: Parameter " << GetParameterId(slot)
+          << " was filled twice for the same event.";
+    }
+    Filled[slot] = 1;
+    FilledSlots.push_back(slot);
+    return Data.data() + Offsets[slot];
+  }
+  double *OpenParameter(systtools::paramId_t pid) {
+    size_t slot = GetSlot(pid);
+    if (slot == systtools::kParamUnhandled<size_t>) {
+      throw invalid_response_arena()
+          << "[ERROR]: EventResponseArena has no slot for parameter " << pid
+          << ".";
+    }
+    return Open(slot);
+  }
+
+  /// Copies a response calculated by a provider that does not write to the
+  /// arena directly.
+  void Add(systtools::ParamResponses const &pr) {
+    size_t slot = GetSlot(pr.pid);
+    if ((slot != systtools::kParamUnhandled<size_t>) &&
+        (pr.responses.size() != CVInfos[slot].NVariations)) {
+      throw invalid_response_arena()
+          << "[ERROR]: Parameter " << pr.pid << " returned "
+          << pr.responses.size() << " responses, but EventResponseArena "
+          << "expected " << CVInfos[slot].NVariations << ".";
+    }
+    double *resp = OpenParameter(pr.pid);
+    std::copy(pr.responses.begin(), pr.responses.end(), resp);
+  }
+  void Add(systtools::event_unit_response_t const &eur) {
+    for (systtools::ParamResponses const &pr : eur) {
+      Add(pr);
+    }
+  }
+
+  /// Filled slots, in the order that they were filled.
+  size_t GetNFilled() const { return FilledSlots.size(); }
+  size_t GetFilledSlot(size_t f_it) const { return FilledSlots[f_it]; }
+  bool IsFilled(size_t slot) const { return Filled[slot]; }
+
+  /// Flags the responses in a filled slot as emulated rather than calculated
+  /// exactly, see IGENIESystProvider_tool::GetEmulatedParameters.
+  void SetEmulated(size_t slot) { Emulated[slot] = 1; }
+  bool IsEmulated(size_t slot) const { return Emulated[slot]; }
+
+  double const *GetResponses(size_t slot) const {
+    return Data.data() + Offsets[slot];
+  }
+  double GetCVResponse(size_t slot) const { return CVResponses[slot]; }
+
+  /// Separates the CV response from the variation responses of every filled
+  /// parameter, in the same way as
+  /// IGENIESystProvider_tool::GetVariationAndCVResponse.
+  void SeparateCVResponses() {
+    for (size_t slot : FilledSlots) {
+      CVResponses[slot] =
+          SeparateCVResponse(CVInfos[slot], Data.data() + Offsets[slot]);
+    }
+  }
+
+  /// Copies out the filled responses, allocates.
+  systtools::event_unit_response_t GetEventResponse() const {
+    systtools::event_unit_response_t eur;
+    for (size_t slot : FilledSlots) {
+      eur.push_back({GetParameterId(slot),
+                     {GetResponses(slot),
+                      GetResponses(slot) + CVInfos[slot].NVariations}});
+    }
+    return eur;
+  }
+  systtools::event_unit_response_w_cv_t GetEventVariationAndCVResponse() const {
+    systtools::event_unit_response_w_cv_t eur;
+    for (size_t slot : FilledSlots) {
+      eur.push_back({GetParameterId(slot),
+                     CVResponses[slot],
+                     {GetResponses(slot),
+                      GetResponses(slot) + CVInfos[slot].NVariations}});
+    }
+    return eur;
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "nusystematics/interface/ParameterSlots.hh"
+
+#include "systematicstools/interface/SystMetaData.hh"
+#include "systematicstools/interface/types.hh"
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(invalid_response_block);
+
+/// Contiguous [param][variation][event] storage for the responses to a batch
+/// of events.
+///
+/// The responses to a single parameter variation across the whole batch are
+/// contiguous, so that providers can fill them with tight loops over events.
+/// Parameters that a provider does not handle for a given event are left at
+/// the default response (1 for weights, 0 otherwise) and flagged as
+/// unhandled.
+class EventResponseBlock {
+
+  size_t NEvents;
+
+  ParameterSlots Slots;
+  std::vector<size_t> NVariations;
+  std::vector<double> DefaultResponses;
+
+  std::vector<size_t> Offsets;
+  std::vector<double> Data;
+  std::vector<uint8_t> Handled;
+  std::vector<uint8_t> Emulated;
+
+public:
+  EventResponseBlock() : NEvents(0) {}
+  explicit EventResponseBlock(systtools::SystMetaData const &md)
+      : NEvents(0) {
+    for (systtools::SystParamHeader const &hdr : md) {
+      AddParameter(hdr);
+    }
+  }
+
+  /// Responseless parameters do not get a row in the block.
+  void AddParameter(systtools::SystParamHeader const &hdr) {
+    if (hdr.isResponselessParam) {
+      return;
+    }
+    Slots.Add(hdr.systParamId);
+    NVariations.push_back(hdr.isCorrection ? 1 : hdr.paramVariations.size());
+    DefaultResponses.push_back(hdr.isWeightSystematicVariation ? 1 : 0);
+    Reset(NEvents);
+  }
+
+  size_t GetNEvents() const { return NEvents; }
+  size_t GetNParameters() const { return Slots.size(); }
+
+  /// Rows are assigned in the order that parameters are added, so a block
+  /// built from response_helper::GetParameterSlots shares its slots.
+  ParameterSlots const &GetParameterSlots() const { return Slots; }
+
+  bool HasParameter(systtools::paramId_t pid) const { return Slots.Has(pid); }
+  /// Returns systtools::kParamUnhandled<size_t> for unknown parameters.
+  size_t GetParameterIndex(systtools::paramId_t pid) const {
+    return Slots.GetSlot(pid);
+  }
+  systtools::paramId_t GetParameterId(size_t pidx) const {
+    return Slots.GetParameterId(pidx);
+  }
+  size_t GetNVariations(size_t pidx) const { return NVariations[pidx]; }
+
+  /// Resizes the block for NEvs events and resets every response to its
+  /// default value.
+  void Reset(size_t NEvs) {
+    NEvents = NEvs;
+    Offsets.resize(Slots.size());
+    size_t NResponses = 0;
+    for (size_t p_it = 0; p_it < Slots.size(); ++p_it) {
+      Offsets[p_it] = NResponses;
+      NResponses += NVariations[p_it] * NEvents;
+    }
+    Data.resize(NResponses);
+    for (size_t p_it = 0; p_it < Slots.size(); ++p_it) {
+      std::fill_n(Data.begin() + Offsets[p_it], NVariations[p_it] * NEvents,
+                  DefaultResponses[p_it]);
+    }
+    Handled.assign(Slots.size() * NEvents, 0);
+    Emulated.assign(Slots.size() * NEvents, 0);
+  }
+
+  /// The NEvents responses to variation var of the pidx-th parameter.
+  double *GetResponses(size_t pidx, size_t var) {
+    return Data.data() + Offsets[pidx] + var * NEvents;
+  }
+  double const *GetResponses(size_t pidx, size_t var) const {
+    return Data.data() + Offsets[pidx] + var * NEvents;
+  }
+
+  double &At(size_t pidx, size_t var, size_t ev) {
+    return Data[Offsets[pidx] + var * NEvents + ev];
+  }
+  double At(size_t pidx, size_t var, size_t ev) const {
+    return Data[Offsets[pidx] + var * NEvents + ev];
+  }
+
+  void SetHandled(size_t pidx, size_t ev, bool handled = true) {
+    Handled[pidx * NEvents + ev] = handled;
+  }
+  bool IsHandled(size_t pidx, size_t ev) const {
+    return Handled[pidx * NEvents + ev];
+  }
+  /// Flags the responses to the pidx-th parameter for event ev as emulated
+  /// rather than calculated exactly, see
+  /// IGENIESystProvider_tool::GetEmulatedParameters.
+  void SetEmulated(size_t pidx, size_t ev) {
+    Emulated[pidx * NEvents + ev] = 1;
+  }
+  bool IsEmulated(size_t pidx, size_t ev) const {
+    return Emulated[pidx * NEvents + ev];
+  }
+  /// Flags the pidx-th parameter as handled for every event in the block.
+  void SetHandled(size_t pidx) {
+    std::fill_n(Handled.begin() + pidx * NEvents, NEvents, 1);
+  }
+
+  /// Flags every parameter in md as handled for event ev, leaving the
+  /// responses at their defaults. Equivalent to filling from
+  /// ISystProviderTool::GetDefaultEventResponse.
+  void SetDefaultEventResponse(systtools::SystMetaData const &md, size_t ev) {
+    for (systtools::SystParamHeader const &hdr : md) {
+      size_t pidx = GetParameterIndex(hdr.systParamId);
+      if (pidx != systtools::kParamUnhandled<size_t>) {
+        SetHandled(pidx, ev);
+      }
+    }
+  }
+
+  /// Scatters a per-event response into the block.
+  void SetEventResponse(size_t ev, systtools::event_unit_response_t const &eur) {
+    for (systtools::ParamResponses const &pr : eur) {
+      size_t pidx = GetParameterIndex(pr.pid);
+      if (pidx == systtools::kParamUnhandled<size_t>) {
+        throw invalid_response_block()
+            << "[ERROR]: EventResponseBlock has no row for parameter "
+            << pr.pid << ".";
+      }
+      if (pr.responses.size() != NVariations[pidx]) {
+        throw invalid_response_block()
+            << "[ERROR]: Parameter " << pr.pid << " returned "
+            << pr.responses.size() << " responses, but EventResponseBlock "
+            << "expected " << NVariations[pidx] << ".";
+      }
+      for (size_t v_it = 0; v_it < NVariations[pidx]; ++v_it) {
+        At(pidx, v_it, ev) = pr.responses[v_it];
+      }
+      SetHandled(pidx, ev);
+    }
+  }
+
+  /// Gathers the handled parameter responses for event ev.
+  systtools::event_unit_response_t GetEventResponse(size_t ev) const {
+    systtools::event_unit_response_t eur;
+    for (size_t p_it = 0; p_it < Slots.size(); ++p_it) {
+      if (!IsHandled(p_it, ev)) {
+        continue;
+      }
+      eur.push_back({Slots.GetParameterId(p_it), {}});
+      for (size_t v_it = 0; v_it < NVariations[p_it]; ++v_it) {
+        eur.back().responses.push_back(At(p_it, v_it, ev));
+      }
+    }
+    return eur;
+  }
+};
+
+} // namespace nusyst
@@ -1,5 +1,15 @@
 #pragma once
 
+#include "nusystematics/interface/CVResponseTable.hh"
+#include "nusystematics/interface/EventApplicability.hh"
+#include "nusystematics/interface/EventResponseArena.hh"
+#include "nusystematics/interface/EventResponseBlock.hh"
+
+#include "nusystematics/utility/EventKinematics.hh"
+#include "nusystematics/utility/ResponseProfiler.hh"
+#include "nusystematics/utility/ResponseTracer.hh"
+#include "nusystematics/utility/TemplateCache.hh"
+
 #include "systematicstools/interface/ISystProviderTool.hh"
 
 #include "fhiclcpp/ParameterSet.h"
@@ -10,10 +20,56 @@
 #include "Framework/Utils/RunOpt.h"
 #include "Framework/Utils/XSecSplineList.h"
 
+#include "TDirectory.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace nusyst {
 
 class IGENIESystProvider_tool : public systtools::ISystProviderTool {
+  std::unique_ptr<EventResponseArena> ScratchArena;
+  std::unique_ptr<CVResponseTable> CVTable;
+
 protected:
+  /// Per-parameter CV handling, built from the configured headers on first
+  /// use.
+  CVResponseTable const &GetCVResponseTable() {
+    if (!CVTable) {
+      CVTable = std::make_unique<CVResponseTable>(GetSystMetaData());
+    }
+    return *CVTable;
+  }
+
+  /// Implements GetEventResponse for providers that override
+  /// FillEventResponse, so that the response is only calculated in one place.
+  systtools::event_unit_response_t
+  GetEventResponseFromArena(genie::EventRecord const &ev,
+                            EventKinematics const &kin) {
+    if (!ScratchArena) {
+      ScratchArena = std::make_unique<EventResponseArena>(GetSystMetaData());
+    }
+    ScratchArena->Reset();
+    FillEventResponse(ev, kin, *ScratchArena);
+    return ScratchArena->GetEventResponse();
+  }
+
+  /// Should be narrowed by providers during SetupResponseCalculator if they
+  /// only respond to a subset of events.
+  EventApplicability applicability;
+
+  /// The key under which this provider caches the template called name.
+  std::string GetTemplateCacheKey(std::string const &name) {
+    return GetFullyQualifiedName() + "/" + name;
+  }
+
+  /// Non-null when the owning response_helper is profiling. Providers that
+  /// calculate each parameter separately can record per-parameter latencies
+  /// with ResponseProfiler::RecordParameter.
+  ResponseProfiler *profiler;
+
   // Based on GENIEHelper::FindTune()
   // TODO: reduce code duplication here
   // -- S. Gardiner, 20 December 2018
@@ -69,8 +125,9 @@ protected:
 
 public:
   IGENIESystProvider_tool(fhicl::ParameterSet const &ps)
-      : ISystProviderTool(ps), fGENIEModuleLabel(ps.get<std::string>(
-                                   "genie_module_label", "generator")) {
+      : ISystProviderTool(ps), profiler(nullptr),
+        fGENIEModuleLabel(ps.get<std::string>("genie_module_label",
+                                              "generator")) {
 
     std::string tune_name =
         ps.get<std::string>("TuneName", "${GENIE_XSEC_TUNE}");
@@ -79,10 +136,69 @@ public:
 
   NEW_SYSTTOOLS_EXCEPT(invalid_response);
 
+  /// The events that this provider can respond to, used by response_helper
+  /// to skip providers that would return a trivial response.
+  EventApplicability const &GetEventApplicability() const {
+    return applicability;
+  }
+
+  void SetResponseProfiler(ResponseProfiler *p) { profiler = p; }
+
+  /// Whether identically configured instances can be used concurrently on
+  /// different threads, each giving exactly the responses of a single
+  /// instance used serially. parallel_response_helper refuses to replicate
+  /// providers that return false.
+  ///
+  /// \note Providers that share process-wide state while calculating
+  /// responses, or whose responses depend on which events an instance has
+  /// seen, must override this.
+  virtual bool SupportsParallelReplicas() const { return true; }
+
+  /// The parameters whose responses to some events may be emulated rather
+  /// than calculated exactly. Providers flag each such response with
+  /// EventResponseArena::SetEmulated or EventResponseBlock::SetEmulated.
+  virtual std::vector<systtools::paramId_t> GetEmulatedParameters() const {
+    return {};
+  }
+
+  /// Writes any diagnostics gathered while calculating responses to dir,
+  /// usually the file that the responses are written to. Called by the
+  /// owning application once every event has been processed.
+  virtual void WriteDiagnostics(TDirectory *) {}
+
+  /// Writes every template loaded during setup, see BuildTemplateCacheNuSyst.
+  ///
+  /// \note Providers that override this should load the same templates from
+  /// TemplateCache::GetActive() during setup, when it is set, instead of from
+  /// their input files.
+  virtual void WriteTemplateCache(TemplateCacheWriter &) {}
+
   /// Calculates configured response for a given GHep record
   virtual systtools::event_unit_response_t
   GetEventResponse(genie::EventRecord const &) = 0;
 
+  /// Calculates configured response for a given GHep record, reusing the
+  /// kinematics that have already been extracted from it.
+  ///
+  /// \note Providers that use the shared kinematics should override this and
+  /// implement GetEventResponse(genie::EventRecord const &) by building them.
+  virtual systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &ev, EventKinematics const &) {
+    return GetEventResponse(ev);
+  }
+
+  /// Writes the configured response for a given GHep record into arena in
+  /// place.
+  ///
+  /// \note The default implementation copies the response from
+  /// GetEventResponse, so allocates. Providers should override it to write
+  /// into the slots returned by EventResponseArena::Open.
+  virtual void FillEventResponse(genie::EventRecord const &ev,
+                                 EventKinematics const &kin,
+                                 EventResponseArena &arena) {
+    arena.Add(GetEventResponse(ev, kin));
+  }
+
   /// Calculates configured response for a given vector of GHep record
   std::unique_ptr<systtools::EventResponse>
   GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &gheps){
@@ -97,73 +213,65 @@ public:
 
   };
 
+  /// Calculates configured responses for a batch of GHep records, filling the
+  /// rows of block that correspond to this provider's parameters.
+  ///
+  /// \note The caller is responsible for sizing and resetting block. The
+  /// default implementation scatters the per-event responses, providers with
+  /// cheap analytic responses should override it with loops over the batch.
+  virtual void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+                    EventResponseBlock &block) {
+    for (size_t eu_it = 0; eu_it < gheps.size(); ++eu_it) {
+      block.SetEventResponse(eu_it, GetEventResponse(*gheps[eu_it]));
+    }
+  }
+
   systtools::event_unit_response_w_cv_t
   GetEventVariationAndCVResponse(genie::EventRecord const &GenieGHep) {
-    systtools::event_unit_response_w_cv_t responseandCV;
+    return GetVariationAndCVResponse(GetEventResponse(GenieGHep));
+  }
+
+  systtools::event_unit_response_w_cv_t
+  GetEventVariationAndCVResponse(genie::EventRecord const &GenieGHep,
+                                 EventKinematics const &kin) {
+    return GetVariationAndCVResponse(GetEventResponse(GenieGHep, kin));
+  }
+
+  /// Separates the CV response from the variation responses of a
+  /// provider response.
+  systtools::event_unit_response_w_cv_t
+  GetVariationAndCVResponse(systtools::event_unit_response_t prov_response) {
+    CVResponseTable const &table = GetCVResponseTable();
 
-    systtools::event_unit_response_t prov_response =
-        GetEventResponse(GenieGHep);
+    systtools::event_unit_response_w_cv_t responseandCV;
+    responseandCV.reserve(prov_response.size());
 
     // Foreach param
     for (systtools::ParamResponses &pr : prov_response) {
-      // Get CV resp
-      systtools::SystParamHeader const &hdr =
-          GetParam(GetSystMetaData(), pr.pid);
-
-      // If not a correction dial, responses and paramVariations should have same size
-      if ( !hdr.isCorrection &&
-           (pr.responses.size() != hdr.paramVariations.size())
-      ) {
-        throw invalid_response()
-            << "[ERROR]: Parameter: " << hdr.prettyName << ", with "
-            << hdr.paramVariations.size() << " parameter variations, returned "
-            << pr.responses.size() << " responses.";
-      }
-      // make sure correction dial has zero paramVariations.size()
-      if( hdr.isCorrection && hdr.paramVariations.size() != 0 ){
+      size_t idx = table.GetIndex(pr.pid);
+      if (idx == systtools::kParamUnhandled<size_t>) {
         throw invalid_response()
-            << "[ERROR]: Parameter: " << hdr.prettyName << " is a correction but has non-zero parameter variations ("
-            << hdr.paramVariations.size() << ").";
+            << "[ERROR]: " << GetFullyQualifiedName()
+            << " returned a response for parameter " << pr.pid
+            << ", which it does not handle.";
       }
-      // make sure correction dial has exactly one response
-      if( hdr.isCorrection && pr.responses.size() != 1 ){
+      ParamCVInfo const &info = table.GetInfo(idx);
+
+      // If not a correction dial, responses and paramVariations should have
+      // same size, a correction dial should have exactly one response.
+      if (pr.responses.size() != info.NVariations) {
         throw invalid_response()
-            << "[ERROR]: Parameter: " << hdr.prettyName << " is a correction and should have single response, but got"
+            << "[ERROR]: Parameter: " << pr.pid << ", expecting "
+            << info.NVariations << " responses, returned "
             << pr.responses.size() << " responses.";
       }
 
-      double CVResp = hdr.isWeightSystematicVariation ? 1 : 0;
-      size_t NVars = hdr.paramVariations.size(); // note: NVars is zero for correction dial
-
-      // If CV is different from default, find it from paramVariations and get the CV weight,
-      // then divide all the weights by this CV weight.
-      // Analyzers should apply the CV weight first and then multiply each response
-      if (hdr.centralParamValue != systtools::kDefaultDouble) {
-        // note: NVars is zero for correction dial
-        for (size_t idx = 0; idx < NVars; ++idx) {
-          if (fabs(hdr.centralParamValue - hdr.paramVariations[idx]) <=
-              std::numeric_limits<float>::epsilon()) {
-            CVResp = pr.responses[idx];
-            break;
-          }
-        }
-        // if we didn't find it, the CVResp stays as 1/0 depending on whether it
-        // is a weight or not.
-        for (size_t idx = 0; idx < NVars; ++idx) {
-          if (hdr.isWeightSystematicVariation) {
-            pr.responses[idx] /= CVResp; // divide the responses by CV weight
-          } else {
-            pr.responses[idx] -= CVResp;
-          }
-        }
-        // For a correction dial, we have NVars=0, so manually update CVResp and responses
-        if( hdr.isCorrection ){
-          CVResp = pr.responses[0];
-          pr.responses[0] = 1.;
-        }
-      }
+      // Analyzers should apply the CV weight first and then multiply each
+      // response
+      double CVResp = SeparateCVResponse(info, pr.responses.data());
 
-      responseandCV.push_back({pr.pid, CVResp, pr.responses});
+      responseandCV.push_back({pr.pid, CVResp, std::move(pr.responses)});
     } // end for parameter response
 
     return responseandCV;
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "systematicstools/interface/types.hh"
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(invalid_parameter_slot);
+
+/// Dense, stable slot indices for a set of parameter ids.
+///
+/// Slots are assigned in the order that parameters are added and looked up by
+/// parameter id in constant time, so that response containers and output
+/// writers built from the same ParameterSlots can address parameters by slot
+/// instead of searching for them.
+class ParameterSlots {
+  std::vector<systtools::paramId_t> ParamIds;
+  std::vector<size_t> SlotsByParamId;
+
+public:
+  /// Returns the slot assigned to pid.
+  size_t Add(systtools::paramId_t pid) {
+    if (pid < 0) {
+      throw invalid_parameter_slot()
+          << "[ERROR]: Cannot assign a slot to invalid parameter id " << pid
+          << ".";
+    }
+    if (size_t(pid) >= SlotsByParamId.size()) {
+      SlotsByParamId.resize(size_t(pid) + 1,
+                            systtools::kParamUnhandled<size_t>);
+    }
+    if (SlotsByParamId[size_t(pid)] != systtools::kParamUnhandled<size_t>) {
+      throw invalid_parameter_slot()
+          << "[ERROR]: Parameter " << pid << " was assigned a slot twice.";
+    }
+    SlotsByParamId[size_t(pid)] = ParamIds.size();
+    ParamIds.push_back(pid);
+    return ParamIds.size() - 1;
+  }
+
+  size_t size() const { return ParamIds.size(); }
+
+  /// Returns systtools::kParamUnhandled<size_t> for unknown parameters.
+  size_t GetSlot(systtools::paramId_t pid) const {
+    return ((pid < 0) || (size_t(pid) >= SlotsByParamId.size()))
+               ? systtools::kParamUnhandled<size_t>
+               : SlotsByParamId[size_t(pid)];
+  }
+  bool Has(systtools::paramId_t pid) const {
+    return GetSlot(pid) != systtools::kParamUnhandled<size_t>;
+  }
+  systtools::paramId_t GetParameterId(size_t slot) const {
+    return ParamIds[slot];
+  }
+};
+
+} // namespace nusyst
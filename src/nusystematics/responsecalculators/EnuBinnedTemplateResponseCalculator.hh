@@ -6,6 +6,12 @@
 
 #include "systematicstools/utility/string_parsers.hh"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace nusyst {
 
 NEW_SYSTTOOLS_EXCEPT(non_contiguous_enu_range);
@@ -18,6 +24,10 @@ NEW_SYSTTOOLS_EXCEPT(non_contiguous_enu_range);
 template <class TRC> class EnuBinnedTemplateResponseCalculator {
 public:
   typedef Int_t enu_bin_it_t;
+  /// Indexes every template bin of every Enu bin, see GetFlatBin.
+  typedef size_t flat_bin_it_t;
+  static constexpr flat_bin_it_t kFlatBinOutsideRange =
+      std::numeric_limits<flat_bin_it_t>::max();
 
 private:
   static std::string StringifyNumberToOneDP(double number) {
@@ -33,6 +43,27 @@ private:
   std::vector<double> EnuBinning;
   std::vector<TRC> EnuResponses;
 
+  /// Set if EnuBinning is uniform, in which case GetEnuBin can calculate bins
+  /// directly rather than searching for them.
+  bool UniformEnuBinning;
+  double EnuInvBinWidth;
+  /// The first flat bin of each Enu bin.
+  std::vector<flat_bin_it_t> EnuBinOffsets;
+  flat_bin_it_t NFlatBins;
+
+  /// Set when loaded from a TemplateCache, which may also hold the resolved
+  /// responses.
+  std::shared_ptr<TemplateCache const> Cache;
+  std::string CacheKey;
+
+  /// The responses to the ResolvedValues passed to ResolveVariations,
+  /// indexed [flat bin][variation]. Points either into ResolvedResponses or
+  /// into Cache.
+  std::vector<double> ResolvedValues;
+  std::vector<double> ResolvedResponses;
+  double const *Resolved;
+  size_t NResolvedVariations;
+
   /// Reads and loads input fhicl
   ///
   /// Expected fhicl like:
@@ -210,31 +241,120 @@ private:
     }
   }
 
+  void BuildEnuBinLookup() {
+    UniformEnuBinning = (EnuBinning.size() >= 2);
+    EnuInvBinWidth = 0;
+    if (UniformEnuBinning) {
+      double width = (EnuBinning.back() - EnuBinning.front()) /
+                     double(EnuBinning.size() - 1);
+      for (size_t bi_it = 0; bi_it < (EnuBinning.size() - 1); ++bi_it) {
+        if (fabs((EnuBinning[bi_it + 1] - EnuBinning[bi_it]) - width) >
+            (1E-8 * width)) {
+          UniformEnuBinning = false;
+          break;
+        }
+      }
+      EnuInvBinWidth = 1 / width;
+    }
+
+    EnuBinOffsets.clear();
+    NFlatBins = 0;
+    for (TRC const &er : EnuResponses) {
+      EnuBinOffsets.push_back(NFlatBins);
+      NFlatBins += er.GetNGlobalBins();
+    }
+  }
+
   enu_bin_it_t GetEnuBin(double enu_GeV) const {
     if (EnuBinning.size() < 2) {
       return kBinOutsideRange;
     }
-    if ((enu_GeV < EnuBinning.front()) || (enu_GeV >= EnuBinning.back())) {
+    if (!(enu_GeV >= EnuBinning.front()) || !(enu_GeV < EnuBinning.back())) {
       return kBinOutsideRange;
     }
-    for (enu_bin_it_t bi_it = 0; bi_it < enu_bin_it_t(EnuBinning.size() - 1);
-         ++bi_it) {
-      if ((enu_GeV >= EnuBinning[bi_it]) && (enu_GeV < EnuBinning[bi_it + 1])) {
-        return bi_it;
+    if (UniformEnuBinning) {
+      enu_bin_it_t NEnuBins = enu_bin_it_t(EnuBinning.size() - 1);
+      enu_bin_it_t bi_it = std::min(
+          enu_bin_it_t((enu_GeV - EnuBinning.front()) * EnuInvBinWidth),
+          NEnuBins - 1);
+      // The calculated bin can be one out for values right on a bin edge, as
+      // the edges themselves were accumulated with rounding.
+      if (enu_GeV < EnuBinning[bi_it]) {
+        --bi_it;
+      } else if (enu_GeV >= EnuBinning[bi_it + 1]) {
+        ++bi_it;
       }
+      return bi_it;
     }
-    return kBinOutsideRange;
+    return enu_bin_it_t(std::upper_bound(EnuBinning.begin(), EnuBinning.end(),
+                                         enu_GeV) -
+                        EnuBinning.begin()) -
+           1;
   }
 
 public:
-  EnuBinnedTemplateResponseCalculator(fhicl::ParameterSet const &ps) {
+  EnuBinnedTemplateResponseCalculator(fhicl::ParameterSet const &ps)
+      : Resolved(nullptr), NResolvedVariations(0) {
     LoadInputHistograms(ps);
+    BuildEnuBinLookup();
   };
 
+  /// Loads the contents written by WriteTemplateCache under key, see
+  /// TemplateResponseCalculatorBase::LoadTemplateCache.
+  EnuBinnedTemplateResponseCalculator(
+      std::shared_ptr<TemplateCache const> cache, std::string const &key)
+      : Cache(cache), CacheKey(key), Resolved(nullptr),
+        NResolvedVariations(0) {
+    std::vector<TemplateCacheArray> const &arrays =
+        cache->GetRecord(key + "/EnuBinning");
+    if ((arrays.size() != 2) || (arrays[1].size != 1)) {
+      throw invalid_template_cache()
+          << "[ERROR]: Template cache record " << key << "/EnuBinning in "
+          << cache->GetPath() << " is inconsistent.";
+    }
+    EnuBinning.assign(arrays[0].data, arrays[0].data + arrays[0].size);
+    size_t NEnuResponses = size_t(arrays[1].data[0]);
+    for (size_t ebi_it = 0; ebi_it < NEnuResponses; ++ebi_it) {
+      EnuResponses.emplace_back();
+      EnuResponses.back().LoadTemplateCache(
+          cache, key + "/EnuBin" + std::to_string(ebi_it));
+    }
+    BuildEnuBinLookup();
+  }
+
+  /// Also writes the table built by ResolveVariations, if it has been
+  /// called, so that calculators loaded from the cache and resolving the
+  /// same values can read it in place.
+  void WriteTemplateCache(TemplateCacheWriter &writer,
+                          std::string const &key) const {
+    writer.AddRecord(key + "/EnuBinning",
+                     {EnuBinning, {double(EnuResponses.size())}});
+    for (size_t ebi_it = 0; ebi_it < EnuResponses.size(); ++ebi_it) {
+      EnuResponses[ebi_it].WriteTemplateCache(
+          writer, key + "/EnuBin" + std::to_string(ebi_it));
+    }
+    if (Resolved) {
+      writer.AddRecord(
+          key + "/Resolved",
+          {ResolvedValues,
+           std::vector<double>(Resolved, Resolved + (NFlatBins *
+                                                     NResolvedVariations))});
+    }
+  }
+
   EnuBinnedTemplateResponseCalculator(
       EnuBinnedTemplateResponseCalculator &&other)
       : EnuBinning(std::move(other.EnuBinning)),
-        EnuResponses(std::move(other.EnuResponses)) {}
+        EnuResponses(std::move(other.EnuResponses)),
+        UniformEnuBinning(other.UniformEnuBinning),
+        EnuInvBinWidth(other.EnuInvBinWidth),
+        EnuBinOffsets(std::move(other.EnuBinOffsets)),
+        NFlatBins(other.NFlatBins), Cache(std::move(other.Cache)),
+        CacheKey(std::move(other.CacheKey)),
+        ResolvedValues(std::move(other.ResolvedValues)),
+        ResolvedResponses(std::move(other.ResolvedResponses)),
+        Resolved(other.Resolved),
+        NResolvedVariations(other.NResolvedVariations) {}
 
   virtual std::pair<enu_bin_it_t, typename TRC::bin_it_t>
   GetBin(double enu_GeV,
@@ -247,6 +367,22 @@ public:
     return {ebi_it, EnuResponses[ebi_it].GetBin(kinematics)};
   }
   
+  /// A single index over the template bins of every Enu bin, or
+  /// kFlatBinOutsideRange, for use with GetResolvedResponses.
+  flat_bin_it_t
+  GetFlatBin(double enu_GeV,
+             std::array<double, TRC::NDimensions> const &kinematics) const {
+    enu_bin_it_t ebi_it = GetEnuBin(enu_GeV);
+    if (ebi_it == kBinOutsideRange) {
+      return kFlatBinOutsideRange;
+    }
+    typename TRC::bin_it_t bin = EnuResponses[ebi_it].GetBin(kinematics);
+    if (bin == kBinOutsideRange) {
+      return kFlatBinOutsideRange;
+    }
+    return EnuBinOffsets[ebi_it] + flat_bin_it_t(bin);
+  }
+
   // virtual destructor required
   virtual ~EnuBinnedTemplateResponseCalculator() = default;
 
@@ -262,6 +398,68 @@ public:
     return GetVariation(val, GetBin(enu_GeV, kinematics));
   }
 
+  /// Resolves vals to template slots separately in every Enu bin, as each may
+  /// load a different set of values. Indexed [Enu bin][value], see
+  /// TemplateResponseCalculatorBase::GetVariationSlots.
+  std::vector<std::vector<size_t>>
+  GetVariationSlots(std::vector<double> const &vals) const {
+    std::vector<std::vector<size_t>> slots;
+    for (TRC const &er : EnuResponses) {
+      slots.push_back(er.GetVariationSlots(vals));
+    }
+    return slots;
+  }
+
+  /// slot must have been resolved for bin.first, which must not be
+  /// kBinOutsideRange.
+  double GetVariationBySlot(
+      size_t slot, std::pair<enu_bin_it_t, typename TRC::bin_it_t> bin) const {
+    return EnuResponses[bin.first].GetVariationBySlot(slot, bin.second);
+  }
+
+  /// Gathers the responses to vals in every bin into one table, so that they
+  /// can be looked up from a single GetFlatBin. Values resolved to
+  /// kNoVariationSlot by GetVariationSlots get a unit response.
+  ///
+  /// If the table for the same vals was written to the cache that this
+  /// calculator was loaded from, it is read from there in place.
+  void ResolveVariations(std::vector<double> const &vals) {
+    ResolvedValues = vals;
+    NResolvedVariations = vals.size();
+    ResolvedResponses.clear();
+
+    if (Cache && Cache->HasRecord(CacheKey + "/Resolved")) {
+      std::vector<TemplateCacheArray> const &arrays =
+          Cache->GetRecord(CacheKey + "/Resolved");
+      if ((arrays.size() == 2) &&
+          std::equal(vals.begin(), vals.end(), arrays[0].data,
+                     arrays[0].data + arrays[0].size) &&
+          (arrays[1].size == (NFlatBins * NResolvedVariations))) {
+        Resolved = arrays[1].data;
+        return;
+      }
+    }
+
+    std::vector<std::vector<size_t>> slots = GetVariationSlots(vals);
+    for (size_t ebi_it = 0; ebi_it < EnuResponses.size(); ++ebi_it) {
+      TRC const &er = EnuResponses[ebi_it];
+      for (size_t bi_it = 0; bi_it < er.GetNGlobalBins(); ++bi_it) {
+        double const *bin_resp = er.GetBinResponses(bi_it);
+        for (size_t slot : slots[ebi_it]) {
+          ResolvedResponses.push_back(
+              (slot == TRC::kNoVariationSlot) ? 1 : bin_resp[slot]);
+        }
+      }
+    }
+    Resolved = ResolvedResponses.data();
+  }
+
+  /// The responses in bin to every value passed to ResolveVariations. bin
+  /// must not be kFlatBinOutsideRange.
+  double const *GetResolvedResponses(flat_bin_it_t bin) const {
+    return Resolved + (bin * NResolvedVariations);
+  }
+
   bool IsValidVariation(double val) {
     return EnuResponses.front().IsValidVariation(val);
   }
@@ -24,13 +24,33 @@ class MINERvARPAq0q3_ReWeight
 
   enum bin_indices { kIndex_q0 = 0, kIndex_q3 = 1 };
 
+  /// The template slot of each tweak, indexed by e2i(tweak) + 1, or
+  /// kNoVariationSlot if no template was loaded for it.
+  std::array<size_t, 3> TweakSlots;
+
+  void ResolveTweakSlots() {
+    for (int tweak = -1; tweak < 2; ++tweak) {
+      TweakSlots[tweak + 1] = IsValidVariation(tweak) ? GetVariationSlot(tweak)
+                                                      : kNoVariationSlot;
+    }
+  }
+
 public:
   enum class RPATweak_t { kCV = 0, kPlus1 = 1, kMinus1 = -1 };
 
   MINERvARPAq0q3_ReWeight(fhicl::ParameterSet const &InputManifest) {
     LoadInputHistograms(InputManifest);
+    ResolveTweakSlots();
+  }
+
+  MINERvARPAq0q3_ReWeight(std::shared_ptr<TemplateCache const> cache,
+                          std::string const &key) {
+    LoadTemplateCache(std::move(cache), key);
+    ResolveTweakSlots();
   }
 
+  using TemplateResponseCalculatorBase::WriteTemplateCache;
+
   virtual bin_it_t GetBin(std::array<double, 2> const &kinematics) const {
 
     std::array<double, 2> kinematics_var = kinematics;
@@ -41,12 +61,10 @@ public:
       kinematics_var[kIndex_q0] = 0.018 + q0_offsetValenciaGENIE_GeV;
     }
 
-    TH2 *firstHist = BinnedResponses.begin()->second.get();
-
-    Int_t XBin = firstHist->GetXaxis()->FindFixBin(kinematics[kIndex_q3]);
+    Int_t XBin = Axes[0].FindFixBin(kinematics[kIndex_q3]);
     // Hold events outside of the Valencia calculation phase space at the
     // closest valid bin.
-    if (IsFlowBin(firstHist->GetXaxis(), XBin)) {
+    if (Axes[0].IsFlowBin(XBin)) {
       XBin = (XBin == 0) ? XBin + 1 : XBin - 1;
     }
 #ifdef MINERvARPAq0q3_ReWeight_DEBUG
@@ -54,11 +72,11 @@ public:
               << std::endl;
 #endif
 
-    Int_t YBin = firstHist->GetYaxis()->FindFixBin(kinematics_var[kIndex_q0] -
-                                                   q0_offsetValenciaGENIE_GeV);
+    Int_t YBin = Axes[1].FindFixBin(kinematics_var[kIndex_q0] -
+                                    q0_offsetValenciaGENIE_GeV);
     // Hold events outside of the Valencia calculation phase space at the
     // closest valid bin.
-    if (IsFlowBin(firstHist->GetYaxis(), YBin)) {
+    if (Axes[1].IsFlowBin(YBin)) {
       YBin = (YBin == 0) ? YBin + 1 : YBin - 1;
     }
 
@@ -68,7 +86,7 @@ public:
               << std::endl;
 #endif
 
-    return firstHist->GetBin(XBin, YBin);
+    return GetGlobalBin({{XBin, YBin}});
   }
 
   double GetWeightQ2(const double Q2_GeV2, RPATweak_t tweak = RPATweak_t::kCV) {
@@ -120,11 +138,18 @@ public:
       if (Q2_GeV2 > 3.0) {
         weight = GetWeightQ2(Q2_GeV2, tweak);
       } else {
+        size_t slot = TweakSlots[e2i(tweak) + 1];
+        if (slot == kNoVariationSlot) {
+          throw invalid_MINERvA_RPA_tweak()
+              << "[ERROR]: No template was loaded for MINERvA RPA tweak "
+              << e2i(tweak);
+        }
+
         int bin2d = GetBin(std::array<double, 2>{{q0_GeV, q3_GeV}});
 #ifdef MINERvARPAq0q3_ReWeight_DEBUG
         std::cout << "\t\tGot bin: " << bin2d << std::endl;
 #endif
-        weight = GetVariation(e2i(tweak), bin2d);
+        weight = GetVariationBySlot(slot, bin2d);
 
         // now trap bogus entries.  Not sure why they happen, but set to 1.0 not
         // 0.0
@@ -139,7 +164,7 @@ public:
 #ifdef MINERvARPAq0q3_ReWeight_DEBUG
           std::cout << "\t\t[INFO]: Moved to bulk bin: " << bin2d << std::endl;
 #endif
-          weight = GetVariation(e2i(tweak), bin2d);
+          weight = GetVariationBySlot(slot, bin2d);
         }
       }
     }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "nusystematics/utility/NewtonPolynomial.hh"
+#include "nusystematics/utility/TemplateCache.hh"
+
 #include "systematicstools/interface/types.hh"
 
 #include "systematicstools/interpreters/PolyResponse.hh"
@@ -14,6 +17,13 @@
 #include "TH3.h"
 #include "TSpline.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
 // #define TemplateResponseCalculatorBase_DEBUG
 
 namespace nusyst {
@@ -22,24 +32,122 @@ NEW_SYSTTOOLS_EXCEPT(no_responses_loaded);
 NEW_SYSTTOOLS_EXCEPT(incompatible_number_of_bins);
 NEW_SYSTTOOLS_EXCEPT(bad_value_ordering);
 
+/// A copy of a template histogram axis that finds bins exactly as
+/// TAxis::FindFixBin does, without touching ROOT. Uniform axes are binned
+/// arithmetically, variable axes with a branch-free binary search.
+struct TemplateAxis {
+  Int_t NBins;
+  double Min, Max;
+  double Range;
+  /// The lower edges of every bin, empty for uniform axes.
+  std::vector<double> LowEdges;
+
+  TemplateAxis() : NBins(0), Min(0), Max(0), Range(0) {}
+  explicit TemplateAxis(TAxis const *axis)
+      : NBins(axis->GetNbins()), Min(axis->GetXmin()), Max(axis->GetXmax()),
+        Range(Max - Min) {
+    if (axis->GetXbins()->GetSize()) {
+      for (Int_t bi_it = 1; bi_it <= NBins; ++bi_it) {
+        LowEdges.push_back(axis->GetBinLowEdge(bi_it));
+      }
+    }
+  }
+
+  /// As written by GetCacheArray.
+  explicit TemplateAxis(TemplateCacheArray const &arr)
+      : NBins(Int_t(arr.data[0])), Min(arr.data[1]), Max(arr.data[2]),
+        Range(Max - Min), LowEdges(arr.data + 3, arr.data + arr.size) {}
+
+  /// NBins, Min and Max followed by LowEdges.
+  std::vector<double> GetCacheArray() const {
+    std::vector<double> arr{double(NBins), Min, Max};
+    arr.insert(arr.end(), LowEdges.begin(), LowEdges.end());
+    return arr;
+  }
+
+  Int_t FindFixBin(double x) const {
+    if (x < Min) {
+      return 0;
+    }
+    if (!(x < Max)) {
+      return NBins + 1;
+    }
+    if (LowEdges.empty()) {
+      // The same operations as TAxis, so that values on a bin edge round the
+      // same way; a multiplication by the inverse width does not.
+      return std::min(1 + Int_t(NBins * (x - Min) / Range), NBins);
+    }
+    double const *base = LowEdges.data();
+    size_t n = LowEdges.size();
+    while (n > 1) {
+      size_t half = n / 2;
+      base = (base[half] <= x) ? (base + half) : base;
+      n -= half;
+    }
+    return 1 + Int_t(base - LowEdges.data());
+  }
+
+  bool IsFlowBin(Int_t bin) const { return (bin == 0) || (bin > NBins); }
+};
+
 template <size_t NDims, bool Continuous = true, size_t PolyResponseOrder = 5>
 class TemplateResponseCalculatorBase {
+public:
+  typedef Int_t bin_it_t;
 
 protected:
-  std::vector<systtools::PolyResponse<PolyResponseOrder>>
-      InterpolatedBinResponses;
+  static size_t const NPolyCoefficients = PolyResponseOrder + 1;
+
   std::map<double, std::unique_ptr<typename THType<NDims>::type>>
       BinnedResponses;
 
+  /// The binning of the templates, shared by every variation.
+  std::array<TemplateAxis, NDims> Axes;
+  /// The values of BinnedResponses, in the same order.
+  std::vector<double> VariationValues;
+  /// Every template's contents, indexed [ROOT global bin][variation], so
+  /// that all variations of one bin are contiguous.
+  std::vector<double> FlatResponses;
+  /// The continuous response of every bin as a polynomial in
+  /// t = (val - PolyCentre) * PolyInvHalfRange, indexed [bin][coefficient]
+  /// in increasing powers of t.
+  std::vector<double> PolyCoefficients;
+  double PolyCentre, PolyInvHalfRange;
+
+  /// The number of ROOT global bins in each template.
+  size_t NGlobalBins;
+  /// The contents of FlatResponses and PolyCoefficients, which point into
+  /// Cache instead if the template was loaded with LoadTemplateCache.
+  double const *Responses;
+  double const *Coefficients;
+  std::shared_ptr<TemplateCache const> Cache;
+
   void ValidateInputHistograms();
   void BuildInterpolatedResponses();
+  void BuildFlatResponses();
+
+  /// The ROOT global bin number of the given per-axis bins.
+  bin_it_t GetGlobalBin(std::array<Int_t, NDims> const &bins) const {
+    bin_it_t gbin = 0;
+    for (size_t d = NDims; d > 0; --d) {
+      gbin = (gbin * (Axes[d - 1].NBins + 2)) + bins[d - 1];
+    }
+    return gbin;
+  }
 
 public:
   static size_t const NDimensions = NDims;
   TemplateResponseCalculatorBase();
   TemplateResponseCalculatorBase(TemplateResponseCalculatorBase &&other)
-      : InterpolatedBinResponses(std::move(other.InterpolatedBinResponses)),
-        BinnedResponses(std::move(other.BinnedResponses)) {}
+      : BinnedResponses(std::move(other.BinnedResponses)),
+        Axes(std::move(other.Axes)),
+        VariationValues(std::move(other.VariationValues)),
+        FlatResponses(std::move(other.FlatResponses)),
+        PolyCoefficients(std::move(other.PolyCoefficients)),
+        PolyCentre(other.PolyCentre),
+        PolyInvHalfRange(other.PolyInvHalfRange),
+        NGlobalBins(other.NGlobalBins), Responses(other.Responses),
+        Coefficients(other.Coefficients), Cache(std::move(other.Cache)) {}
 
   /// Reads and loads input fhicl
   ///
@@ -58,7 +166,12 @@ public:
   ///  }
   void LoadInputHistograms(fhicl::ParameterSet const &ps);
 
-  typedef Int_t bin_it_t;
+  /// Loads the contents written by WriteTemplateCache under key, instead of
+  /// LoadInputHistograms. Responses are read in place from cache.
+  void LoadTemplateCache(std::shared_ptr<TemplateCache const> cache,
+                         std::string const &key);
+  void WriteTemplateCache(TemplateCacheWriter &writer,
+                          std::string const &key) const;
 
   virtual bin_it_t GetBin(std::array<double, NDims> const &) const;
 
@@ -79,6 +192,62 @@ public:
   double GetVariation(double val,
                       std::array<double, NDims> const &kinematics) const;
 
+  /// Evaluates the continuous response in bin at NVals values at once,
+  /// which costs little more than a single GetVariation for a few tens of
+  /// values.
+  template <bool IsCont = Continuous>
+  typename std::enable_if<IsCont>::type
+  GetVariations(bin_it_t bin, double const *vals, size_t NVals,
+                double *responses) const;
+
+  template <size_t N>
+  std::array<double, N> GetVariations(bin_it_t bin,
+                                      std::array<double, N> const &vals) const {
+    std::array<double, N> responses;
+    GetVariations(bin, vals.data(), N, responses.data());
+    return responses;
+  }
+
+  /// The responses in bin to every loaded variation, in the order of
+  /// GetValidVariations for a discrete template.
+  double const *GetBinResponses(bin_it_t bin) const {
+    return Responses + (size_t(bin) * VariationValues.size());
+  }
+
+  /// The number of ROOT global bins, including flow bins.
+  size_t GetNGlobalBins() const { return NGlobalBins; }
+
+  /// Marks a configured variation that has no loaded template.
+  static constexpr size_t kNoVariationSlot =
+      std::numeric_limits<size_t>::max();
+
+  /// The index of the discrete template loaded at val into the responses
+  /// returned by GetBinResponses. Resolve configured variations once at
+  /// setup and look responses up with GetVariationBySlot.
+  ///
+  /// Throws systtools::invalid_parameter_value if no template was loaded at
+  /// val.
+  size_t GetVariationSlot(double val) const;
+
+  /// Resolves every value with GetVariationSlot, except that 0 is resolved to
+  /// kNoVariationSlot if no template was loaded there.
+  std::vector<size_t>
+  GetVariationSlots(std::vector<double> const &vals) const {
+    std::vector<size_t> slots;
+    for (double val : vals) {
+      slots.push_back(((val == 0) && !IsValidVariation(0))
+                          ? kNoVariationSlot
+                          : GetVariationSlot(val));
+    }
+    return slots;
+  }
+
+  /// As GetVariation for a discrete template, but neither searches nor
+  /// throws.
+  double GetVariationBySlot(size_t slot, bin_it_t bin) const {
+    return (bin == kBinOutsideRange) ? 1 : GetBinResponses(bin)[slot];
+  }
+
   std::vector<double> GetValidVariations() const;
   bool IsValidVariation(double val) const;
 };
@@ -128,6 +297,7 @@ void TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
   }
 
   ValidateInputHistograms();
+  BuildFlatResponses();
   if (Continuous) {
     BuildInterpolatedResponses();
   }
@@ -138,7 +308,45 @@ typename TemplateResponseCalculatorBase<NDims, Continuous,
                                         PolyResponseOrder>::bin_it_t
 TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::GetBin(
     std::array<double, NDims> const &vals) const {
-  return THType<NDims>::GetBin(BinnedResponses.begin()->second.get(), vals);
+  std::array<Int_t, NDims> bins;
+  for (size_t d = 0; d < NDims; ++d) {
+    bins[d] = Axes[d].FindFixBin(vals[d]);
+    if (Axes[d].IsFlowBin(bins[d])) {
+      return kBinOutsideRange;
+    }
+  }
+  return GetGlobalBin(bins);
+}
+
+template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
+void TemplateResponseCalculatorBase<NDims, Continuous,
+                                    PolyResponseOrder>::BuildFlatResponses() {
+  typename THType<NDims>::type const *first =
+      BinnedResponses.begin()->second.get();
+  for (size_t d = 0; d < NDims; ++d) {
+    Axes[d] = TemplateAxis((d == 0) ? first->GetXaxis()
+                                    : ((d == 1) ? first->GetYaxis()
+                                                : first->GetZaxis()));
+  }
+
+  VariationValues.clear();
+  for (auto const &var : BinnedResponses) {
+    VariationValues.push_back(var.first);
+  }
+
+  size_t NVars = VariationValues.size();
+  size_t NBins = THType<NDims>::GetNbins(BinnedResponses.begin()->second, true);
+  FlatResponses.assign(NBins * NVars, 0);
+  size_t var_it = 0;
+  for (auto const &var : BinnedResponses) {
+    for (size_t bi_it = 0; bi_it < NBins; ++bi_it) {
+      FlatResponses[(bi_it * NVars) + var_it] =
+          var.second->GetBinContent(bi_it);
+    }
+    ++var_it;
+  }
+  NGlobalBins = NBins;
+  Responses = FlatResponses.data();
 }
 
 template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
@@ -148,7 +356,7 @@ void TemplateResponseCalculatorBase<
   std::vector<double> yvals_dummy;
   std::vector<double> yvals;
   for (auto const &var : BinnedResponses) {
-    if (var.first < xvals.back()) {
+    if (xvals.size() && (var.first < xvals.back())) {
       throw bad_value_ordering()
           << "[ERROR]: When precalculating response functions, found value "
              "specification for "
@@ -159,7 +367,21 @@ void TemplateResponseCalculatorBase<
     yvals_dummy.push_back(1);
   }
 
+  // The fitted responses are re-expressed in a variable scaled to [-1, 1]
+  // over the loaded values, through their values at Chebyshev nodes, which
+  // keeps the monomial coefficients well conditioned.
+  PolyCentre = (xvals.front() + xvals.back()) / 2;
+  double HalfRange = (xvals.back() - xvals.front()) / 2;
+  PolyInvHalfRange = 1 / HalfRange;
+  std::array<double, NPolyCoefficients> t_nodes, val_nodes, resp_nodes;
+  for (size_t n_it = 0; n_it < NPolyCoefficients; ++n_it) {
+    t_nodes[n_it] = std::cos(M_PI * double(2 * n_it + 1) /
+                             double(2 * NPolyCoefficients));
+    val_nodes[n_it] = PolyCentre + (HalfRange * t_nodes[n_it]);
+  }
+
   size_t NBins = THType<NDims>::GetNbins(BinnedResponses.begin()->second, true);
+  PolyCoefficients.assign(NBins * NPolyCoefficients, 0);
   for (size_t bi_it = 0; bi_it < NBins; ++bi_it) {
     yvals.clear();
     for (auto const &var : BinnedResponses) {
@@ -169,13 +391,25 @@ void TemplateResponseCalculatorBase<
       }
       yvals.push_back(var.second->GetBinContent(bi_it));
     }
-    InterpolatedBinResponses.emplace_back(xvals, yvals);
+    systtools::PolyResponse<PolyResponseOrder> bin_response(xvals, yvals);
+    for (size_t n_it = 0; n_it < NPolyCoefficients; ++n_it) {
+      resp_nodes[n_it] = bin_response.eval(val_nodes[n_it]);
+    }
+    std::array<double, NPolyCoefficients> coeffs =
+        NewtonPolynomial<NPolyCoefficients>(t_nodes.data(), resp_nodes.data(),
+                                            NPolyCoefficients)
+            .GetMonomialCoefficients();
+    std::copy(coeffs.begin(), coeffs.end(),
+              PolyCoefficients.begin() + (bi_it * NPolyCoefficients));
   }
+  Coefficients = PolyCoefficients.data();
 }
 
 template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
-TemplateResponseCalculatorBase<
-    NDims, Continuous, PolyResponseOrder>::TemplateResponseCalculatorBase() {}
+TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
+    TemplateResponseCalculatorBase()
+    : PolyCentre(0), PolyInvHalfRange(0), NGlobalBins(0), Responses(nullptr),
+      Coefficients(nullptr) {}
 
 template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
 template <bool IsCont>
@@ -183,7 +417,44 @@ typename std::enable_if<IsCont, double>::type
 TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
     GetVariation(double val,
                  typename std::enable_if<IsCont, bin_it_t>::type bin) const {
-  return InterpolatedBinResponses[bin]->eval(val);
+  double response;
+  GetVariations(bin, &val, 1, &response);
+  return response;
+}
+
+template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
+template <bool IsCont>
+typename std::enable_if<IsCont>::type
+TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
+    GetVariations(bin_it_t bin, double const *vals, size_t NVals,
+                  double *responses) const {
+  if (bin == kBinOutsideRange) {
+    std::fill_n(responses, NVals, 1);
+    return;
+  }
+
+  double const *coeffs = Coefficients + (size_t(bin) * NPolyCoefficients);
+
+  // Horner's scheme across a block of values at a time: each step is a
+  // multiply-add over contiguous values that the compiler vectorises.
+  static size_t const kBlockSize = 32;
+  double t[kBlockSize];
+  for (size_t blk_it = 0; blk_it < NVals; blk_it += kBlockSize) {
+    size_t NBlock = std::min(kBlockSize, NVals - blk_it);
+    double *resp = responses + blk_it;
+    for (size_t v_it = 0; v_it < NBlock; ++v_it) {
+      t[v_it] = (vals[blk_it + v_it] - PolyCentre) * PolyInvHalfRange;
+    }
+    for (size_t v_it = 0; v_it < NBlock; ++v_it) {
+      resp[v_it] = coeffs[NPolyCoefficients - 1];
+    }
+    for (size_t c_it = NPolyCoefficients - 1; c_it > 0; --c_it) {
+      double const c = coeffs[c_it - 1];
+      for (size_t v_it = 0; v_it < NBlock; ++v_it) {
+        resp[v_it] = (resp[v_it] * t[v_it]) + c;
+      }
+    }
+  }
 }
 
 template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
@@ -197,16 +468,22 @@ TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
     return 1;
   }
 
-  for (auto const &resp : BinnedResponses) {
-    if (fabs(val - resp.first) <
-        (std::numeric_limits<double>::epsilon() * 1E4)) {
+  size_t slot = GetVariationSlot(val);
 #ifdef TemplateResponseCalculatorBase_DEBUG
-      std::cout << "[INFO]: Getting bin content for bin: " << bin
-                << " at value: " << val << " = "
-                << resp.second->GetBinContent(bin)
-                << " from hist: " << resp.second->GetName() << std::endl;
+  std::cout << "[INFO]: Getting bin content for bin: " << bin
+            << " at value: " << val << " = " << GetBinResponses(bin)[slot]
+            << std::endl;
 #endif
-      return resp.second->GetBinContent(bin);
+  return GetBinResponses(bin)[slot];
+}
+
+template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
+size_t TemplateResponseCalculatorBase<
+    NDims, Continuous, PolyResponseOrder>::GetVariationSlot(double val) const {
+  for (size_t var_it = 0; var_it < VariationValues.size(); ++var_it) {
+    if (fabs(val - VariationValues[var_it]) <
+        (std::numeric_limits<double>::epsilon() * 1E4)) {
+      return var_it;
     }
   }
 
@@ -234,22 +511,11 @@ template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
 std::vector<double>
 TemplateResponseCalculatorBase<NDims, Continuous,
                                PolyResponseOrder>::GetValidVariations() const {
-  std::vector<double> vals;
-  if (Continuous) {
-    std::pair<double, double> minmax{std::numeric_limits<double>::max(),
-                                     -std::numeric_limits<double>::max()};
-    for (auto const &var : BinnedResponses) {
-      minmax.first = std::min(minmax.first, var.first);
-      minmax.second = std::max(minmax.second, var.first);
-    }
-    vals.push_back(minmax.first);
-    vals.push_back(minmax.second);
-  } else {
-    for (auto const &var : BinnedResponses) {
-      vals.push_back(var.first);
-    }
+  // VariationValues is ordered, as it is filled from BinnedResponses.
+  if (Continuous && VariationValues.size()) {
+    return {VariationValues.front(), VariationValues.back()};
   }
-  return vals;
+  return VariationValues;
 }
 
 template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
@@ -268,6 +534,61 @@ bool TemplateResponseCalculatorBase<
   }
 }
 
+template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
+void TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
+    WriteTemplateCache(TemplateCacheWriter &writer,
+                       std::string const &key) const {
+  std::vector<std::vector<double>> arrays;
+  arrays.push_back({double(NDims), double(Continuous),
+                    double(PolyResponseOrder), double(NGlobalBins), PolyCentre,
+                    PolyInvHalfRange});
+  for (size_t d = 0; d < NDims; ++d) {
+    arrays.push_back(Axes[d].GetCacheArray());
+  }
+  arrays.push_back(VariationValues);
+  arrays.emplace_back(Responses,
+                      Responses + (NGlobalBins * VariationValues.size()));
+  arrays.emplace_back(Coefficients,
+                      Coefficients +
+                          (Coefficients ? (NGlobalBins * NPolyCoefficients)
+                                        : 0));
+  writer.AddRecord(key, arrays);
+}
+
+template <size_t NDims, bool Continuous, size_t PolyResponseOrder>
+void TemplateResponseCalculatorBase<NDims, Continuous, PolyResponseOrder>::
+    LoadTemplateCache(std::shared_ptr<TemplateCache const> cache,
+                      std::string const &key) {
+  std::vector<TemplateCacheArray> const &arrays = cache->GetRecord(key);
+  if ((arrays.size() != (NDims + 4)) || (arrays[0].size != 6) ||
+      (arrays[0].data[0] != NDims) || (arrays[0].data[1] != Continuous) ||
+      (arrays[0].data[2] != PolyResponseOrder)) {
+    throw invalid_template_cache()
+        << "[ERROR]: Template cache record " << key << " in "
+        << cache->GetPath() << " was not written by a " << NDims
+        << "D " << (Continuous ? "continuous" : "discrete") << " "
+        << GetCalculatorName();
+  }
+  NGlobalBins = size_t(arrays[0].data[3]);
+  PolyCentre = arrays[0].data[4];
+  PolyInvHalfRange = arrays[0].data[5];
+  for (size_t d = 0; d < NDims; ++d) {
+    Axes[d] = TemplateAxis(arrays[1 + d]);
+  }
+  VariationValues.assign(arrays[NDims + 1].data,
+                         arrays[NDims + 1].data + arrays[NDims + 1].size);
+  Responses = arrays[NDims + 2].data;
+  Coefficients = arrays[NDims + 3].size ? arrays[NDims + 3].data : nullptr;
+  if ((arrays[NDims + 2].size != (NGlobalBins * VariationValues.size())) ||
+      (Continuous &&
+       (arrays[NDims + 3].size != (NGlobalBins * NPolyCoefficients)))) {
+    throw invalid_template_cache()
+        << "[ERROR]: Template cache record " << key << " in "
+        << cache->GetPath() << " is inconsistent.";
+  }
+  Cache = std::move(cache);
+}
+
 typedef TemplateResponseCalculatorBase<2, false> TemplateResponse2DDiscrete;
 typedef TemplateResponseCalculatorBase<3, false> TemplateResponse3DDiscrete;
 
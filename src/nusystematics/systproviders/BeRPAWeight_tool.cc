@@ -147,19 +147,33 @@ bool BeRPAWeight::SetupResponseCalculator(
     InitValidTree();
   }
 
+  // Only CC QE events get a response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kQE}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kEmpty);
+
   return true;
 }
 
 event_unit_response_t
 BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+event_unit_response_t
+BeRPAWeight::GetEventResponse(genie::EventRecord const &ev,
+                              EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
+
+void BeRPAWeight::FillEventResponse(genie::EventRecord const &ev,
+                                    EventKinematics const &kin,
+                                    EventResponseArena &arena) {
 
-  event_unit_response_t resp;
   SystMetaData const &md = GetSystMetaData();
 
-  if (!ev.Summary()->ProcInfo().IsQuasiElastic() ||
-      !ev.Summary()->ProcInfo().IsWeakCC() ||
-      ev.Summary()->ExclTag().IsCharmEvent()) {
-    return resp;
+  if ((kin.mode != simb_mode_copy::kQE) || !kin.IsCC || kin.IsCharm) {
+    return;
   }
 
 #ifdef BERPAWEIGHT_DEBUG
@@ -167,16 +181,11 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
     std::cout << "[INFO]: QE event with high W (NEUT: "
               << genie::utils::ghep::NeutReactionCode(&ev) << ") " << std::endl
               << DumpGENIEEv(ev) << std::endl;
-    return resp;
+    return;
   }
 #endif
 
-  genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-  genie::GHepParticle *ISLep = ev.Probe();
-  TLorentzVector FSLepP4 = *FSLep->P4();
-  TLorentzVector ISLepP4 = *ISLep->P4();
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-  Q2 = -emTransfer.Mag2();
+  Q2 = kin.Q2;
 
   // Only want the CV response to be used in one of the dials, after the first
   // dial is found, all other dial responses should be /= CVResponse.
@@ -188,8 +197,10 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
             << ECV << "] = " << CVResponse << std::endl;
 #endif
 
+  size_t NFilled = arena.GetNFilled();
+
   if (!ignore_parameter_dependence) {
-    resp.push_back({md[pidx_BeRPA_Response].systParamId, {}});
+    double *resp = arena.OpenParameter(md[pidx_BeRPA_Response].systParamId);
 
     for (size_t univ = 0; univ < md[pidx_BeRPA_Response].paramVariations.size();
          ++univ) {
@@ -205,14 +216,15 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
         weight /= CVResponse;
       }
 
-      resp.back().responses.push_back(weight);
+      resp[univ] = weight;
     }
   } else {
 
     bool UsedADial = false;
     if (pidx_BeRPA_A != kParamUnhandled<size_t>) {
-      resp.push_back({md[pidx_BeRPA_A].systParamId, {}});
-      for (double av : AVariations) {
+      double *resp = arena.OpenParameter(md[pidx_BeRPA_A].systParamId);
+      for (size_t v_it = 0; v_it < AVariations.size(); ++v_it) {
+        double av = AVariations[v_it];
         double weight = GetBeRPAWeight(e2i(simb_mode_copy::kQE), true, Q2, av,
                                        BCV, DCV, ECV);
 #ifdef BERPAWEIGHT_DEBUG
@@ -222,13 +234,14 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
         if (!ApplyCV) {
           weight /= CVResponse;
         }
-        resp.back().responses.push_back(weight);
+        resp[v_it] = weight;
       }
       UsedADial = true;
     }
     if (pidx_BeRPA_B != kParamUnhandled<size_t>) {
-      resp.push_back({md[pidx_BeRPA_B].systParamId, {}});
-      for (double bv : BVariations) {
+      double *resp = arena.OpenParameter(md[pidx_BeRPA_B].systParamId);
+      for (size_t v_it = 0; v_it < BVariations.size(); ++v_it) {
+        double bv = BVariations[v_it];
         double weight = GetBeRPAWeight(e2i(simb_mode_copy::kQE), true, Q2, ACV,
                                        bv, DCV, ECV);
 #ifdef BERPAWEIGHT_DEBUG
@@ -238,13 +251,14 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
         if (!ApplyCV || UsedADial) {
           weight /= CVResponse;
         }
-        resp.back().responses.push_back(weight);
+        resp[v_it] = weight;
       }
       UsedADial = true;
     }
     if (pidx_BeRPA_D != kParamUnhandled<size_t>) {
-      resp.push_back({md[pidx_BeRPA_D].systParamId, {}});
-      for (double dv : DVariations) {
+      double *resp = arena.OpenParameter(md[pidx_BeRPA_D].systParamId);
+      for (size_t v_it = 0; v_it < DVariations.size(); ++v_it) {
+        double dv = DVariations[v_it];
         double weight = GetBeRPAWeight(e2i(simb_mode_copy::kQE), true, Q2, ACV,
                                        BCV, dv, ECV);
 #ifdef BERPAWEIGHT_DEBUG
@@ -254,13 +268,14 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
         if (!ApplyCV || UsedADial) {
           weight /= CVResponse;
         }
-        resp.back().responses.push_back(weight);
+        resp[v_it] = weight;
       }
       UsedADial = true;
     }
     if (pidx_BeRPA_E != kParamUnhandled<size_t>) {
-      resp.push_back({md[pidx_BeRPA_E].systParamId, {}});
-      for (double eval : EVariations) {
+      double *resp = arena.OpenParameter(md[pidx_BeRPA_E].systParamId);
+      for (size_t v_it = 0; v_it < EVariations.size(); ++v_it) {
+        double eval = EVariations[v_it];
         double weight = GetBeRPAWeight(e2i(simb_mode_copy::kQE), true, Q2, ACV,
                                        BCV, DCV, eval);
 #ifdef BERPAWEIGHT_DEBUG
@@ -270,14 +285,14 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
         if (!ApplyCV || UsedADial) {
           weight /= CVResponse;
         }
-        resp.back().responses.push_back(weight);
+        resp[v_it] = weight;
       }
     }
   }
 
   if (fill_valid_tree) {
 
-    int Pdgnu = ISLep->Pdg();
+    int Pdgnu = kin.nu_pdg;
 
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
@@ -287,18 +302,116 @@ BeRPAWeight::GetEventResponse(genie::EventRecord const &ev) {
       NEUTMode = genie::utils::ghep::NeutReactionCode(&ev);
     }
 
-    Enu = ISLepP4.E();
+    Enu = kin.Enu;
     weight = 1;
 
-    for (auto const &eur : resp) {
-      weight *= eur.responses[3];
+    for (size_t f_it = NFilled; f_it < arena.GetNFilled(); ++f_it) {
+      weight *= arena.GetResponses(arena.GetFilledSlot(f_it))[3];
     }
 
     valid_tree->Fill();
   }
+}
+void BeRPAWeight::GetEventResponses(
+    std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+    EventResponseBlock &block) {
+
+  // The validation tree is filled event by event.
+  if (fill_valid_tree) {
+    IGENIESystProvider_tool::GetEventResponses(gheps, block);
+    return;
+  }
+
+  size_t NEvs = gheps.size();
+  batch_IsCCQE.assign(NEvs, 0);
+  batch_Q2.assign(NEvs, 0);
+  batch_CVResponse.assign(NEvs, 1);
+
+  for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+    genie::EventRecord const &ev = *gheps[ev_it];
+    if (!ev.Summary()->ProcInfo().IsQuasiElastic() ||
+        !ev.Summary()->ProcInfo().IsWeakCC() ||
+        ev.Summary()->ExclTag().IsCharmEvent()) {
+      continue;
+    }
+    TLorentzVector emTransfer =
+        (*ev.Probe()->P4() - *ev.FinalStatePrimaryLepton()->P4());
+    batch_IsCCQE[ev_it] = 1;
+    batch_Q2[ev_it] = -emTransfer.Mag2();
+    batch_CVResponse[ev_it] = GetBeRPAWeight(
+        e2i(simb_mode_copy::kQE), true, batch_Q2[ev_it], ACV, BCV, DCV, ECV);
+  }
+
+  SystMetaData const &md = GetSystMetaData();
+
+  auto FillVariation = [&](size_t pidx, size_t univ, double Aval, double Bval,
+                           double Dval, double Eval, bool DivideByCV) {
+    size_t bidx = block.GetParameterIndex(md[pidx].systParamId);
+    double *responses = block.GetResponses(bidx, univ);
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      double weight = GetBeRPAWeight(e2i(simb_mode_copy::kQE), true,
+                                     batch_Q2[ev_it], Aval, Bval, Dval, Eval);
+      if (DivideByCV) {
+        weight /= batch_CVResponse[ev_it];
+      }
+      responses[ev_it] = batch_IsCCQE[ev_it] ? weight : responses[ev_it];
+    }
+  };
 
-  return resp;
+  auto SetHandled = [&](size_t pidx) {
+    size_t bidx = block.GetParameterIndex(md[pidx].systParamId);
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      if (batch_IsCCQE[ev_it]) {
+        block.SetHandled(bidx, ev_it);
+      }
+    }
+  };
+
+  if (!ignore_parameter_dependence) {
+    for (size_t univ = 0; univ < md[pidx_BeRPA_Response].paramVariations.size();
+         ++univ) {
+      FillVariation(pidx_BeRPA_Response, univ, AVariations[univ],
+                    BVariations[univ], DVariations[univ], EVariations[univ],
+                    !ApplyCV);
+    }
+    SetHandled(pidx_BeRPA_Response);
+    return;
+  }
+
+  bool UsedADial = false;
+  if (pidx_BeRPA_A != kParamUnhandled<size_t>) {
+    for (size_t univ = 0; univ < AVariations.size(); ++univ) {
+      FillVariation(pidx_BeRPA_A, univ, AVariations[univ], BCV, DCV, ECV,
+                    !ApplyCV);
+    }
+    SetHandled(pidx_BeRPA_A);
+    UsedADial = true;
+  }
+  if (pidx_BeRPA_B != kParamUnhandled<size_t>) {
+    for (size_t univ = 0; univ < BVariations.size(); ++univ) {
+      FillVariation(pidx_BeRPA_B, univ, ACV, BVariations[univ], DCV, ECV,
+                    !ApplyCV || UsedADial);
+    }
+    SetHandled(pidx_BeRPA_B);
+    UsedADial = true;
+  }
+  if (pidx_BeRPA_D != kParamUnhandled<size_t>) {
+    for (size_t univ = 0; univ < DVariations.size(); ++univ) {
+      FillVariation(pidx_BeRPA_D, univ, ACV, BCV, DVariations[univ], ECV,
+                    !ApplyCV || UsedADial);
+    }
+    SetHandled(pidx_BeRPA_D);
+    UsedADial = true;
+  }
+  if (pidx_BeRPA_E != kParamUnhandled<size_t>) {
+    for (size_t univ = 0; univ < EVariations.size(); ++univ) {
+      FillVariation(pidx_BeRPA_E, univ, ACV, BCV, DCV, EVariations[univ],
+                    !ApplyCV || UsedADial);
+    }
+    SetHandled(pidx_BeRPA_E);
+  }
 }
+
 std::string BeRPAWeight::AsString() { return "BeRPAWeight"; }
 
 void BeRPAWeight::InitValidTree() {
@@ -5,8 +5,10 @@
 #include "TFile.h"
 #include "TTree.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 class BeRPAWeight : public nusyst::IGENIESystProvider_tool {
 
@@ -20,9 +22,22 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
+
+  using nusyst::IGENIESystProvider_tool::GetEventResponses;
+  void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &,
+                    nusyst::EventResponseBlock &);
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~BeRPAWeight();
 
 private:
@@ -38,6 +53,10 @@ private:
 
   std::vector<double> AVariations, BVariations, DVariations, EVariations;
 
+  // Per-batch scratch space, reused between batches.
+  std::vector<uint8_t> batch_IsCCQE;
+  std::vector<double> batch_Q2, batch_CVResponse;
+
   void InitValidTree();
 
   bool fill_valid_tree;
@@ -96,32 +96,46 @@ bool CCQERPAReweight::SetupResponseCalculator(
     InitValidTree();
   }
 
+  // Only CC QE events get a non-trivial response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kQE}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+
   return true;
 }
 
 event_unit_response_t
 CCQERPAReweight::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+event_unit_response_t
+CCQERPAReweight::GetEventResponse(genie::EventRecord const &ev,
+                                  EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
+
+void CCQERPAReweight::FillEventResponse(genie::EventRecord const &ev,
+                                        EventKinematics const &kin,
+                                        EventResponseArena &arena) {
 
   // when the event is not applicable for this type of reweighting,
   // use GetDefaultEventResponse() to return an auto-1.-filled vector
 
-  if (!ev.Summary()->ProcInfo().IsQuasiElastic() ||
-      !ev.Summary()->ProcInfo().IsWeakCC()) {
-    return this->GetDefaultEventResponse();
+  if ((kin.mode != simb_mode_copy::kQE) || !kin.IsCC) {
+    arena.Add(this->GetDefaultEventResponse());
+    return;
   }
 
-  genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-  genie::GHepParticle *ISLep = ev.Probe();
-
-  if (!FSLep || !ISLep) {
+  if (!kin.HasLeptons) {
     throw incorrectly_generated()
         << "[ERROR]: Failed to find IS and FS lepton in event: "
         << ev.Summary()->AsString();
   }
 
-  TLorentzVector FSLepP4 = *FSLep->P4(); // l
-  TLorentzVector ISLepP4 = *ISLep->P4(); // nu
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
+  TLorentzVector const &FSLepP4 = kin.FSLepP4; // l
+  TLorentzVector const &ISLepP4 = kin.ISLepP4; // nu
+  TLorentzVector const &emTransfer = kin.emTransfer;
 
   double AngleLeps = FSLepP4.Vect().Angle( ISLepP4.Vect() );
   double CAngleLeps = TMath::Cos(AngleLeps);
@@ -147,18 +161,16 @@ CCQERPAReweight::GetEventResponse(genie::EventRecord const &ev) {
   }
 
   // now make the output
-  systtools::event_unit_response_t resp;
-
   SystParamHeader const &hdr = GetSystMetaData()[ResponseParameterIdx];
 
-  resp.push_back( {hdr.systParamId, {}} );
-  for (double var : hdr.paramVariations) {
+  double *resp = arena.OpenParameter(hdr.systParamId);
+  for (size_t v_it = 0; v_it < hdr.paramVariations.size(); ++v_it) {
     double this_reweight = ccqeRPAReweightCalculator->GetRPAReweight( 
       ISLepP4.E(),
       bin_kin,
-      var
+      hdr.paramVariations[v_it]
     );
-    resp.back().responses.push_back( this_reweight );
+    resp[v_it] = this_reweight;
   }
 
   if (fill_valid_tree) {
@@ -167,7 +179,7 @@ CCQERPAReweight::GetEventResponse(genie::EventRecord const &ev) {
     momfslep = FSLepP4.Vect().Mag();
     cthetafslep = FSLepP4.Vect().CosTheta();
 
-    Pdgnu = ISLep->Pdg();
+    Pdgnu = kin.nu_pdg;
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
         ev.Summary()->ProcInfo().IsWeakCC()) {
@@ -176,20 +188,17 @@ CCQERPAReweight::GetEventResponse(genie::EventRecord const &ev) {
       NEUTMode = genie::utils::ghep::NeutReactionCode(&ev);
     }
 
-    QELikeTarget_t qel_targ = GetQELikeTarget(ev);
+    QELikeTarget_t qel_targ = GetQELikeTarget(ev, kin);
     QELTarget = e2i(qel_targ);
 
     Enu = ISLepP4.E();
     Q2 = -emTransfer.Mag2();
-    W = ev.Summary()->Kine().W(true);
+    W = GetW(ev, kin);
     q0 = emTransfer.E();
     q3 = emTransfer.Vect().Mag();
 
     valid_tree->Fill();
   }
-
-  return resp;
-
 }
 
 std::string CCQERPAReweight::AsString() { return ""; }
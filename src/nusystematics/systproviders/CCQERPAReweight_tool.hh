@@ -37,9 +37,17 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~CCQERPAReweight();
 
 private:
@@ -347,6 +347,76 @@ DIRT2_Emiss::GetEventResponse(genie::EventRecord const &ev) {
   return resp;
 }
 
+void DIRT2_Emiss::GetEventResponses(
+    std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+    EventResponseBlock &block) {
+
+  // The validation tree is filled event by event.
+  if (fill_valid_tree) {
+    IGENIESystProvider_tool::GetEventResponses(gheps, block);
+    return;
+  }
+
+  size_t NEvs = gheps.size();
+  batch_Emiss_preFSI.resize(NEvs);
+  batch_nucleon_PDG.resize(NEvs);
+  batch_target_PDG.resize(NEvs);
+
+  for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+    genie::EventRecord const &ev = *gheps[ev_it];
+    genie::GHepParticle *nucleon = ev.HitNucleon();
+    batch_Emiss_preFSI[ev_it] = nucleon ? nucleon->RemovalEnergy() : -999;
+    batch_nucleon_PDG[ev_it] = nucleon ? nucleon->Pdg() : -999;
+    batch_target_PDG[ev_it] = ev.TargetNucleus()->Pdg();
+  }
+
+  systtools::SystMetaData const &md = GetSystMetaData();
+
+  auto FillDial = [&](size_t pidx, int target_PDG, int nucleon_PDG,
+                      auto const &EmissRW) {
+    if (pidx == systtools::kParamUnhandled<size_t>) {
+      return;
+    }
+    size_t bidx = block.GetParameterIndex(md[pidx].systParamId);
+    for (size_t var_it = 0; var_it < md[pidx].paramVariations.size();
+         ++var_it) {
+      double var = md[pidx].paramVariations[var_it];
+      double *responses = block.GetResponses(bidx, var_it);
+      for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+        responses[ev_it] = ((batch_target_PDG[ev_it] == target_PDG) &&
+                            (batch_nucleon_PDG[ev_it] == nucleon_PDG))
+                               ? EmissRW(batch_Emiss_preFSI[ev_it], var)
+                               : 1;
+      }
+    }
+    block.SetHandled(bidx);
+  };
+
+  auto CorrTail = [](double Emiss, double var) {
+    return GetEmissCorrTailRW(Emiss, var);
+  };
+  auto Linear = [](double Emiss, double var) {
+    return GetEmissLinearRW(Emiss, var);
+  };
+  auto ShiftPeak = [](double Emiss, double var) {
+    return GetEmissShiftPeakRW(Emiss, var);
+  };
+
+  FillDial(pidx_Emiss_CorrTail_Ar_p, 1000180400, 2212, CorrTail);
+  FillDial(pidx_Emiss_CorrTail_Ar_n, 1000180400, 2112, CorrTail);
+  FillDial(pidx_Emiss_Linear_Ar_p, 1000180400, 2212, Linear);
+  FillDial(pidx_Emiss_Linear_Ar_n, 1000180400, 2112, Linear);
+  FillDial(pidx_Emiss_ShiftPeak_Ar_p, 1000180400, 2212, ShiftPeak);
+  FillDial(pidx_Emiss_ShiftPeak_Ar_n, 1000180400, 2112, ShiftPeak);
+
+  FillDial(pidx_Emiss_CorrTail_C_p, 1000060120, 2212, CorrTail);
+  FillDial(pidx_Emiss_CorrTail_C_n, 1000060120, 2112, CorrTail);
+  FillDial(pidx_Emiss_Linear_C_p, 1000060120, 2212, Linear);
+  FillDial(pidx_Emiss_Linear_C_n, 1000060120, 2112, Linear);
+  FillDial(pidx_Emiss_ShiftPeak_C_p, 1000060120, 2212, ShiftPeak);
+  FillDial(pidx_Emiss_ShiftPeak_C_n, 1000060120, 2112, ShiftPeak);
+}
+
 std::string DIRT2_Emiss::AsString() { return ""; }
 
 void DIRT2_Emiss::InitValidTree() {
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 class DIRT2_Emiss : public nusyst::IGENIESystProvider_tool {
 
@@ -27,8 +28,16 @@ public:
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
 
+  using nusyst::IGENIESystProvider_tool::GetEventResponses;
+  void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &,
+                    nusyst::EventResponseBlock &);
+
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~DIRT2_Emiss();
 
 private:
@@ -49,6 +58,10 @@ private:
   size_t pidx_Emiss_ShiftPeak_C_p;
   size_t pidx_Emiss_ShiftPeak_C_n;
 
+  // Per-batch scratch space, reused between batches.
+  std::vector<double> batch_Emiss_preFSI;
+  std::vector<int> batch_nucleon_PDG, batch_target_PDG;
+
   void InitValidTree();
 
   bool fill_valid_tree;
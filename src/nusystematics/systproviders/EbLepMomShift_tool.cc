@@ -72,7 +72,14 @@ bool EbLepMomShift::SetupResponseCalculator(
 
   ResponseParameterIdx = GetParamIndex(md, "EbFSLepMomShift");
 
-  EbTemplate.LoadInputHistograms(templateManifest);
+  if (std::shared_ptr<TemplateCache const> cache =
+          TemplateCache::GetActive()) {
+    EbTemplate.LoadTemplateCache(cache, GetTemplateCacheKey("EbTemplate"));
+  } else {
+    EbTemplate.LoadInputHistograms(templateManifest);
+  }
+  VariationSlots = EbTemplate.GetVariationSlots(
+      md[ResponseParameterIdx].paramVariations);
 
   fill_valid_tree = tool_options.get("fill_valid_tree", false);
 
@@ -80,44 +87,58 @@ bool EbLepMomShift::SetupResponseCalculator(
     InitValidTree();
   }
 
+  // Only CC QE events get a response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kQE}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kEmpty);
+
   return true;
 }
 
+void EbLepMomShift::WriteTemplateCache(TemplateCacheWriter &writer) {
+  EbTemplate.WriteTemplateCache(writer, GetTemplateCacheKey("EbTemplate"));
+}
+
 event_unit_response_t
 EbLepMomShift::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+event_unit_response_t
+EbLepMomShift::GetEventResponse(genie::EventRecord const &ev,
+                                EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
+
+void EbLepMomShift::FillEventResponse(genie::EventRecord const &ev,
+                                      EventKinematics const &kin,
+                                      EventResponseArena &arena) {
 
-  event_unit_response_t resp;
   SystMetaData const &md = GetSystMetaData();
 
-  if (!ev.Summary()->ProcInfo().IsQuasiElastic() ||
-      !ev.Summary()->ProcInfo().IsWeakCC() || ev.Summary()->ExclTag().IsCharmEvent()) {
-    return resp;
+  if ((kin.mode != simb_mode_copy::kQE) || !kin.IsCC || kin.IsCharm) {
+    return;
   }
 
-  genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-  genie::GHepParticle *ISLep = ev.Probe();
-  TLorentzVector FSLepP4 = *FSLep->P4();
-  TLorentzVector ISLepP4 = *ISLep->P4();
+  TLorentzVector const &FSLepP4 = kin.FSLepP4;
 
-  Enu = ISLepP4.E();
+  Enu = kin.Enu;
   FSLep_ctheta = FSLepP4.Vect().CosTheta();
 
+  double *resp = nullptr;
   int bin = EbTemplate.GetBin({{Enu, FSLep_ctheta}});
   if (bin != kBinOutsideRange) {
-    resp.push_back({md[ResponseParameterIdx].systParamId, {}});
-    for (double v : md[ResponseParameterIdx].paramVariations) {
-      if ((v == 0) && !EbTemplate.IsValidVariation(0)) {
-        resp.back().responses.push_back(0);
-      } else {
-        resp.back().responses.push_back(
-            EbTemplate.GetVariation(v, {{Enu, FSLep_ctheta}}));
-      }
+    double const *bin_resp = EbTemplate.GetBinResponses(bin);
+    resp = arena.OpenParameter(md[ResponseParameterIdx].systParamId);
+    for (size_t v_it = 0; v_it < VariationSlots.size(); ++v_it) {
+      size_t slot = VariationSlots[v_it];
+      resp[v_it] = (slot == EbTemplate.kNoVariationSlot) ? 0 : bin_resp[slot];
     }
   }
 
   if (fill_valid_tree) {
 
-    int Pdgnu = ISLep->Pdg();
+    int Pdgnu = kin.nu_pdg;
 
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
@@ -128,14 +149,12 @@ EbLepMomShift::GetEventResponse(genie::EventRecord const &ev) {
     }
 
     FSLep_pmu = FSLepP4.Vect().Mag();
-    shift = resp.front().responses[3];
+    shift = resp ? resp[3] : 0;
 
     BinOutsideRange = (bin == kBinOutsideRange);
 
     valid_tree->Fill();
   }
-
-  return resp;
 }
 std::string EbLepMomShift::AsString() { return "EbLepMomShift"; }
 
@@ -9,6 +9,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 class EbLepMomShift : public nusyst::IGENIESystProvider_tool {
 
@@ -30,9 +31,19 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
+
+  void WriteTemplateCache(nusyst::TemplateCacheWriter &);
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~EbLepMomShift();
 
 private:
@@ -41,6 +52,8 @@ private:
   size_t ResponseParameterIdx;
 
   EbTemplateResponseEnuFSLepctheta EbTemplate;
+  /// The template slot of each configured variation of the parameter.
+  std::vector<size_t> VariationSlots;
 
   void InitValidTree();
 
@@ -132,9 +132,16 @@ bool FSILikeEAvailSmearing::SetupResponseCalculator(
 
     TemplateHelper th;
     th.Template = std::make_unique<FSILikeEAvailSmearing_ReWeight>();
-    th.Template->LoadInputHistograms(
-        templateManifest.get<fhicl::ParameterSet>(ch.name));
-    th.ZeroIsValid = th.Template->IsValidVariation(0);
+    th.CacheKey = GetTemplateCacheKey(ch.name);
+    if (std::shared_ptr<TemplateCache const> cache =
+            TemplateCache::GetActive()) {
+      th.Template->LoadTemplateCache(cache, th.CacheKey);
+    } else {
+      th.Template->LoadInputHistograms(
+          templateManifest.get<fhicl::ParameterSet>(ch.name));
+    }
+    th.VariationSlots = th.Template->GetVariationSlots(
+        GetSystMetaData()[ResponseParameterIdx].paramVariations);
 
     ChannelParameterMapping.emplace(ch.channel, std::move(th));
   }
@@ -147,6 +154,9 @@ bool FSILikeEAvailSmearing::SetupResponseCalculator(
   genie::Messenger::Instance()->SetPriorityLevel("GHepUtils",
                                                  log4cpp::Priority::FATAL);
 
+  // Coherent events never get a response.
+  applicability = EventApplicability().ExcludeModes({simb_mode_copy::kCoh});
+
   return true;
 }
 
@@ -179,59 +189,70 @@ FSILikeEAvailSmearing::chan GetChan(simb_mode_copy mode, bool IsCC, bool IsNu) {
 
 event_unit_response_t
 FSILikeEAvailSmearing::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+event_unit_response_t
+FSILikeEAvailSmearing::GetEventResponse(genie::EventRecord const &ev,
+                                        EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
 
-  event_unit_response_t resp;
+void FSILikeEAvailSmearing::FillEventResponse(genie::EventRecord const &ev,
+                                              EventKinematics const &kin,
+                                              EventResponseArena &arena) {
 
   // Ignore Coherent
-  simb_mode_copy mode = GetSimbMode(ev);
+  simb_mode_copy mode = kin.mode;
   if (mode == simb_mode_copy::kCoh) {
-    return resp;
+    return;
   }
 
-  genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-  genie::GHepParticle *ISLep = ev.Probe();
-
-  if (!FSLep || !ISLep) {
+  if (!kin.HasLeptons) {
     throw incorrectly_generated()
         << "[ERROR]: Failed to find IS and FS lepton in event: "
         << ev.Summary()->AsString();
   }
 
-  chan evch =
-      GetChan(mode, ev.Summary()->ProcInfo().IsWeakCC(), ISLep->Pdg() > 0);
+  chan evch = GetChan(mode, kin.IsCC, kin.nu_pdg > 0);
 
   if (ChannelParameterMapping.find(evch) == ChannelParameterMapping.end()) {
-    return resp;
+    return;
   }
 
   SystParamHeader const &hdr = GetSystMetaData()[ResponseParameterIdx];
 
-  TLorentzVector FSLepP4 = *FSLep->P4();
-  TLorentzVector ISLepP4 = *ISLep->P4();
-
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-
   std::array<double, 3> kinematics;
-  kinematics[0] = emTransfer.Vect().Mag();
-  kinematics[1] = emTransfer[3];
+  kinematics[0] = kin.q3;
+  kinematics[1] = kin.q0;
   kinematics[2] = GetErecoil_MINERvA_LowRecoil(ev) / kinematics[1];
 
-  resp.push_back({hdr.systParamId, {}});
-  for (double val : hdr.paramVariations) {
+  TemplateHelper const &th = ChannelParameterMapping[evch];
+  FSILikeEAvailSmearing_ReWeight::bin_it_t bin =
+      th.Template->GetBin(kinematics);
+
+  double *resp = arena.OpenParameter(hdr.systParamId);
+  for (size_t v_it = 0; v_it < th.VariationSlots.size(); ++v_it) {
+    size_t slot = th.VariationSlots[v_it];
 
-    if ((val == 0) && !ChannelParameterMapping[evch].ZeroIsValid) {
-      resp.back().responses.push_back(1);
+    if (slot == th.Template->kNoVariationSlot) {
+      resp[v_it] = 1;
     } else {
-      double wght =
-          ChannelParameterMapping[evch].Template->GetVariation(val, kinematics);
+      double wght = th.Template->GetVariationBySlot(slot, bin);
 
       wght = (wght < LimitWeights.first) ? LimitWeights.first : wght;
       wght = (wght > LimitWeights.second) ? LimitWeights.second : wght;
 
-      resp.back().responses.push_back(wght);
+      resp[v_it] = wght;
     }
   }
-  return resp;
+}
+
+void FSILikeEAvailSmearing::WriteTemplateCache(TemplateCacheWriter &writer) {
+  for (auto const &chan_th : ChannelParameterMapping) {
+    TemplateHelper const &th = chan_th.second;
+    th.Template->WriteTemplateCache(writer, th.CacheKey);
+  }
 }
 
 std::string FSILikeEAvailSmearing::AsString() { return ""; }
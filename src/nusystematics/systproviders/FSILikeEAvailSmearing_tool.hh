@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 class FSILikeEAvailSmearing : public nusyst::IGENIESystProvider_tool {
 
@@ -32,7 +33,10 @@ public:
 private:
   struct TemplateHelper {
     std::unique_ptr<nusyst::FSILikeEAvailSmearing_ReWeight> Template;
-    bool ZeroIsValid;
+    std::string CacheKey;
+    /// The template slot of each configured variation, see
+    /// TemplateResponseCalculatorBase::GetVariationSlots.
+    std::vector<size_t> VariationSlots;
   };
 
   std::map<chan, TemplateHelper> ChannelParameterMapping;
@@ -48,6 +52,13 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
+
+  void WriteTemplateCache(nusyst::TemplateCacheWriter &);
 
   std::string AsString();
 
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "nusystematics/systproviders/GENIEResponseParameterAssociation.hh"
+#include "nusystematics/utility/NewtonPolynomial.hh"
+
+#include "systematicstools/interface/SystMetaData.hh"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace nusyst {
+
+size_t const kMaxAdaptiveResponseOrder = 5;
+
+/// Whether the variations of GENIEResponse are values of a single GENIE dial,
+/// so that its response is a smooth function of them. The variations of
+/// multi-dial responses are universe indices.
+inline bool IsSingleDialResponse(GENIEResponseParameter const &GENIEResponse,
+                                 systtools::SystMetaData const &md) {
+  if (GENIEResponse.dependents.size() != 1) {
+    return false;
+  }
+  systtools::SystParamHeader const &hdr = md[GENIEResponse.pidx];
+  systtools::SystParamHeader const &dep_hdr =
+      md[GENIEResponse.dependents.front().pidx];
+  if (dep_hdr.isCorrection ||
+      (dep_hdr.paramVariations.size() != hdr.paramVariations.size())) {
+    return false;
+  }
+  for (size_t var_it = 0; var_it < hdr.paramVariations.size(); ++var_it) {
+    if (std::fabs(dep_hdr.paramVariations[var_it] -
+                  hdr.paramVariations[var_it]) >= 1E-8) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Chooses Order+1 fit variations spread across the range of parameter
+/// values, including both ends so that the polynomial never extrapolates, and
+/// the remaining variation furthest from all of them to check the fit with.
+/// Leaves the parameter non-adaptive if it is not a single-dial response or
+/// if this would not save any GENIE calls.
+inline void PlanAdaptiveSampling(GENIEResponseParameter &GENIEResponse,
+                                 systtools::SystMetaData const &md,
+                                 size_t Order) {
+  GENIEResponse.FitVariations.clear();
+  GENIEResponse.IsSampledVariation.clear();
+  systtools::SystParamHeader const &hdr = md[GENIEResponse.pidx];
+  if (!Order || hdr.isCorrection || !IsSingleDialResponse(GENIEResponse, md)) {
+    return;
+  }
+
+  // One variation per distinct parameter value, in order of value.
+  std::vector<double> const &vals = hdr.paramVariations;
+  std::vector<size_t> distinct(vals.size());
+  std::iota(distinct.begin(), distinct.end(), 0);
+  std::stable_sort(distinct.begin(), distinct.end(),
+                   [&](size_t a, size_t b) { return vals[a] < vals[b]; });
+  distinct.erase(std::unique(distinct.begin(), distinct.end(),
+                             [&](size_t a, size_t b) {
+                               return std::fabs(vals[a] - vals[b]) < 1E-8;
+                             }),
+                 distinct.end());
+  if (distinct.size() < (Order + 3)) {
+    return;
+  }
+
+  size_t NDistinct = distinct.size();
+  std::vector<bool> IsFit(NDistinct, false);
+  for (size_t k = 0; k <= Order; ++k) {
+    size_t d_it = ((2 * k * (NDistinct - 1)) + Order) / (2 * Order);
+    IsFit[d_it] = true;
+    GENIEResponse.FitVariations.push_back(distinct[d_it]);
+  }
+
+  double max_dist = -1;
+  for (size_t d_it = 0; d_it < NDistinct; ++d_it) {
+    if (IsFit[d_it]) {
+      continue;
+    }
+    double dist = std::numeric_limits<double>::max();
+    for (size_t fit_it : GENIEResponse.FitVariations) {
+      dist = std::min(dist, std::fabs(vals[distinct[d_it]] - vals[fit_it]));
+    }
+    if (dist > max_dist) {
+      max_dist = dist;
+      GENIEResponse.CheckVariation = distinct[d_it];
+    }
+  }
+
+  GENIEResponse.IsSampledVariation.resize(vals.size(), false);
+  for (size_t fit_it : GENIEResponse.FitVariations) {
+    GENIEResponse.IsSampledVariation[fit_it] = true;
+  }
+  GENIEResponse.IsSampledVariation[GENIEResponse.CheckVariation] = true;
+}
+
+/// Builds the polynomial through the fit variation responses, returned by
+/// resp(var_it), and if it reproduces the check variation response to within
+/// Tolerance, writes it to every other variation. Returns false, leaving the
+/// unsampled variations untouched, if the check fails.
+template <typename Resp>
+bool FillFromResponsePolynomial(GENIEResponseParameter const &GENIEResponse,
+                                systtools::SystParamHeader const &hdr,
+                                double Tolerance, Resp &&resp) {
+  size_t NFit = GENIEResponse.FitVariations.size();
+  std::array<double, kMaxAdaptiveResponseOrder + 1> x, y;
+  for (size_t i = 0; i < NFit; ++i) {
+    x[i] = hdr.paramVariations[GENIEResponse.FitVariations[i]];
+    y[i] = resp(GENIEResponse.FitVariations[i]);
+  }
+  NewtonPolynomial<kMaxAdaptiveResponseOrder + 1> poly(x.data(), y.data(),
+                                                       NFit);
+
+  size_t check = GENIEResponse.CheckVariation;
+  // Written so that a NaN residual fails the check.
+  if (!(std::fabs(poly.eval(hdr.paramVariations[check]) - resp(check)) <=
+        Tolerance)) {
+    return false;
+  }
+  for (size_t var_it = 0; var_it < hdr.paramVariations.size(); ++var_it) {
+    if (!GENIEResponse.IsSampledVariation[var_it]) {
+      resp(var_it) = poly.eval(hdr.paramVariations[var_it]);
+    }
+  }
+  return true;
+}
+
+} // namespace nusyst
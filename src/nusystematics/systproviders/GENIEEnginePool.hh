@@ -0,0 +1,260 @@
+#pragma once
+
+#include "nusystematics/systproviders/GENIEResponseParameterAssociation.hh"
+
+#include "nusystematics/utility/ProcessMemory.hh"
+
+#include "TROOT.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace nusyst {
+
+/// Independent, fully configured GENIE engines for every response parameter
+/// of a GENIEReWeight instance, as used by a single thread.
+struct GENIEEngineSet {
+  /// Indexed in the same order as the GENIEResponseParameters.
+  std::vector<HERG_t> Hergs;
+  /// Set when GetEventWeightResponse has reconfigured these engines away
+  /// from the configured variations.
+  bool HaveReconfiguredOneOfTheHERG = false;
+
+  struct FamilyBuildStats {
+    /// Engines built for this family, excluding any shared with another
+    /// parameter.
+    size_t NEngines = 0;
+    size_t NShared = 0;
+    /// Summed over engines, so exceeds the wall time of a parallel build.
+    double Seconds = 0;
+    /// The change in resident set size over the NMeasured engines that were
+    /// built serially. Concurrently built engines cannot be told apart.
+    size_t NMeasured = 0;
+    int64_t RSSBytes = 0;
+  };
+  /// The cost of building the engines of each calculator family.
+  std::map<std::string, FamilyBuildStats> BuildStats;
+  /// Wall time spent building the whole set.
+  double BuildSeconds = 0;
+  /// The change in resident set size over building the whole set.
+  int64_t RSSBytes = 0;
+};
+
+/// Lazily builds one GENIEEngineSet per calling thread from a shared list of
+/// GENIEResponseParameter descriptions.
+///
+/// GReWeight instances are stateful, they are reconfigured for each
+/// variation of a reduced HERG, so they cannot be shared between threads.
+/// Each thread gets its own set the first time it calls Get, and the same
+/// set thereafter. Sets are built one at a time, as building engines touches
+/// GENIE's algorithm and configuration singletons.
+///
+/// Experimentally, with NBuildThreads > 1, the first engine of each
+/// calculator and instantiator within a set is built serially, which
+/// populates GENIE's lazily filled algorithm and configuration caches, and
+/// the remaining engines, which should only read those caches, are built
+/// concurrently. GENIE makes no guarantee that this is safe.
+///
+/// With CompactFullHERG, full-HERG engines with identical configurations,
+/// most commonly the engine at the nominal dial values, are built once and
+/// shared between every parameter that uses them.
+class GENIEEnginePool {
+  typedef std::chrono::steady_clock clock;
+
+  std::vector<GENIEResponseParameter> const &Params;
+  size_t NBuildThreads;
+
+  struct EngineSlot {
+    size_t resp_idx, eng_it;
+  };
+  /// For each engine of each parameter, the slot of the engine that it is
+  /// identical to, or itself.
+  std::vector<std::vector<EngineSlot>> SharedSlot;
+
+  std::mutex m;
+  std::map<std::thread::id, std::unique_ptr<GENIEEngineSet>> Sets;
+
+  static std::mutex &GetBuildMutex() {
+    static std::mutex build_mutex;
+    return build_mutex;
+  }
+
+  bool IsShared(size_t resp_idx, size_t eng_it) const {
+    EngineSlot const &shared = SharedSlot[resp_idx][eng_it];
+    return (shared.resp_idx != resp_idx) || (shared.eng_it != eng_it);
+  }
+
+  void BuildEngine(GENIEEngineSet &set, EngineSlot const &slot,
+                   std::vector<double> &seconds) {
+    clock::time_point start = clock::now();
+    set.Hergs[slot.resp_idx][slot.eng_it] =
+        Params[slot.resp_idx].BuildEngine(slot.eng_it);
+    seconds[slot.resp_idx] +=
+        std::chrono::duration<double>(clock::now() - start).count();
+  }
+
+  std::unique_ptr<GENIEEngineSet> BuildSet() {
+    clock::time_point start = clock::now();
+    int64_t start_rss = GetResidentSetBytes();
+    std::unique_ptr<GENIEEngineSet> set = std::make_unique<GENIEEngineSet>();
+
+    // Each engine is written to its own pre-allocated slot, so the workers
+    // never touch the same HERG_t element. Workers accumulate build times
+    // privately and merge them when they finish.
+    std::vector<double> seconds(Params.size(), 0);
+    std::vector<size_t> NMeasured(Params.size(), 0);
+    std::vector<int64_t> rss(Params.size(), 0);
+    std::vector<EngineSlot> deferred;
+    std::map<std::string, bool> CalculatorPrimed;
+    for (size_t resp_idx = 0; resp_idx < Params.size(); ++resp_idx) {
+      GENIEResponseParameter const &param = Params[resp_idx];
+      set->Hergs.emplace_back(param.NEngines());
+      for (size_t eng_it = 0; eng_it < param.NEngines(); ++eng_it) {
+        if (IsShared(resp_idx, eng_it)) {
+          continue;
+        }
+        bool &primed = CalculatorPrimed[param.CalculatorKey()];
+        if (primed && (NBuildThreads > 1)) {
+          deferred.push_back({resp_idx, eng_it});
+          continue;
+        }
+        int64_t engine_start_rss = GetResidentSetBytes();
+        BuildEngine(*set, {resp_idx, eng_it}, seconds);
+        rss[resp_idx] += GetResidentSetBytes() - engine_start_rss;
+        NMeasured[resp_idx]++;
+        primed = true;
+      }
+    }
+
+    if (deferred.size()) {
+      ROOT::EnableThreadSafety();
+      std::atomic<size_t> next(0);
+      std::mutex ex_m;
+      std::exception_ptr worker_exception;
+      auto work = [&]() {
+        std::vector<double> my_seconds(Params.size(), 0);
+        size_t d_it;
+        while ((d_it = next++) < deferred.size()) {
+          try {
+            BuildEngine(*set, deferred[d_it], my_seconds);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(ex_m);
+            if (!worker_exception) {
+              worker_exception = std::current_exception();
+            }
+            next = deferred.size();
+          }
+        }
+        std::lock_guard<std::mutex> lock(ex_m);
+        for (size_t resp_idx = 0; resp_idx < Params.size(); ++resp_idx) {
+          seconds[resp_idx] += my_seconds[resp_idx];
+        }
+      };
+
+      std::vector<std::thread> workers;
+      size_t NWorkers = std::min(NBuildThreads, deferred.size());
+      for (size_t w_it = 1; w_it < NWorkers; ++w_it) {
+        workers.emplace_back(work);
+      }
+      work();
+      for (std::thread &w : workers) {
+        w.join();
+      }
+      if (worker_exception) {
+        std::rethrow_exception(worker_exception);
+      }
+    }
+
+    for (size_t resp_idx = 0; resp_idx < Params.size(); ++resp_idx) {
+      GENIEEngineSet::FamilyBuildStats &bs =
+          set->BuildStats[Params[resp_idx].FamilyName()];
+      for (size_t eng_it = 0; eng_it < Params[resp_idx].NEngines(); ++eng_it) {
+        if (IsShared(resp_idx, eng_it)) {
+          EngineSlot const &shared = SharedSlot[resp_idx][eng_it];
+          set->Hergs[resp_idx][eng_it] =
+              set->Hergs[shared.resp_idx][shared.eng_it];
+          bs.NShared++;
+        } else {
+          bs.NEngines++;
+        }
+      }
+      bs.Seconds += seconds[resp_idx];
+      bs.NMeasured += NMeasured[resp_idx];
+      bs.RSSBytes += rss[resp_idx];
+    }
+    set->BuildSeconds =
+        std::chrono::duration<double>(clock::now() - start).count();
+    set->RSSBytes = GetResidentSetBytes() - start_rss;
+    return set;
+  }
+
+public:
+  /// NBuildThreads of 1 builds every engine serially, larger values enable
+  /// the experimental parallel build and 0 uses one thread per hardware
+  /// thread.
+  GENIEEnginePool(std::vector<GENIEResponseParameter> const &params,
+                  size_t NBuildThreads = 1, bool CompactFullHERG = false)
+      : Params(params), NBuildThreads(NBuildThreads) {
+    if (!this->NBuildThreads) {
+      this->NBuildThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // The single engine of a reduced HERG is reconfigured for each variation,
+    // so is never shared.
+    std::map<std::string, EngineSlot> FirstWithKey;
+    for (size_t resp_idx = 0; resp_idx < Params.size(); ++resp_idx) {
+      GENIEResponseParameter const &param = Params[resp_idx];
+      SharedSlot.emplace_back();
+      for (size_t eng_it = 0; eng_it < param.NEngines(); ++eng_it) {
+        EngineSlot slot{resp_idx, eng_it};
+        if (CompactFullHERG && !param.IsReducedHERG()) {
+          slot = FirstWithKey.emplace(param.EngineKey(eng_it), slot)
+                     .first->second;
+        }
+        SharedSlot.back().push_back(slot);
+      }
+    }
+  }
+
+  GENIEEnginePool(GENIEEnginePool const &) = delete;
+  GENIEEnginePool &operator=(GENIEEnginePool const &) = delete;
+
+  /// The engine set of the calling thread.
+  GENIEEngineSet &Get() {
+    std::thread::id tid = std::this_thread::get_id();
+    {
+      std::lock_guard<std::mutex> lock(m);
+      auto set_it = Sets.find(tid);
+      if (set_it != Sets.end()) {
+        return *set_it->second;
+      }
+    }
+
+    std::unique_ptr<GENIEEngineSet> set;
+    {
+      std::lock_guard<std::mutex> lock(GetBuildMutex());
+      set = BuildSet();
+    }
+
+    std::lock_guard<std::mutex> lock(m);
+    std::unique_ptr<GENIEEngineSet> &slot = Sets[tid];
+    slot = std::move(set);
+    return *slot;
+  }
+
+  /// The number of threads that have been given a set.
+  size_t size() {
+    std::lock_guard<std::mutex> lock(m);
+    return Sets.size();
+  }
+};
+
+} // namespace nusyst
@@ -19,6 +19,7 @@
 #include "RwCalculators/GReWeightResonanceDecay.h"
 #include "RwCalculators/GReWeightDeltaradAngle.h"
 
+#include <cmath>
 #include <functional>
 
 using namespace systtools;
@@ -26,11 +27,83 @@ using namespace genie::rew;
 
 namespace nusyst {
 
+namespace {
+/// Describes the engines for ResponsePar, whose dependents must already be
+/// filled. No engines are built here, see GENIEResponseParameter::BuildHERG.
+///
+/// With UseFullHERG, one engine is described per unique set of dependent
+/// dial values (to within 1E-5) and ResponsePar.VariationEngine maps each
+/// variation onto it, so repeated variations neither hold nor run a
+/// duplicate GReWeight. Otherwise a single engine is described, configured
+/// to the first variation, which is reconfigured as required. Corrections
+/// only ever need the engine at the central values.
+void DescribeHERG(SystMetaData const &md, std::string const &engine_name,
+                  std::function<GReWeightI *()> const &EngineInstantiator,
+                  bool UseFullHERG, GENIEResponseParameter &ResponsePar) {
+
+  std::vector<std::vector<double>> &EngineDialValues =
+      ResponsePar.EngineDialValues;
+  auto AddEngine = [&](std::vector<double> const &dial_values) {
+    EngineDialValues.push_back(dial_values);
+    return EngineDialValues.size() - 1;
+  };
+
+  ResponsePar.Calculators.push_back({engine_name, EngineInstantiator});
+
+  SystParamHeader const &hdr = md[ResponsePar.pidx];
+  std::vector<double> dial_values;
+
+  if (hdr.isCorrection) {
+    for (auto const &dep : ResponsePar.dependents) {
+      dial_values.push_back(md[dep.pidx].centralParamValue);
+    }
+    ResponsePar.VariationEngine.push_back(AddEngine(dial_values));
+    ResponsePar.EngineVariation.push_back(0);
+    return;
+  }
+
+  for (size_t var_it = 0; var_it < hdr.paramVariations.size(); ++var_it) {
+    dial_values.clear();
+    for (auto const &dep : ResponsePar.dependents) {
+      SystParamHeader const &dep_hdr = md[dep.pidx];
+      dial_values.push_back(dep_hdr.isCorrection
+                                ? dep_hdr.centralParamValue
+                                : dep_hdr.paramVariations[var_it]);
+    }
+
+    if (!UseFullHERG) {
+      AddEngine(dial_values);
+      break;
+    }
+
+    size_t eng_it = 0;
+    for (; eng_it < EngineDialValues.size(); ++eng_it) {
+      bool same = true;
+      for (size_t d_it = 0; d_it < dial_values.size(); ++d_it) {
+        if (fabs(EngineDialValues[eng_it][d_it] - dial_values[d_it]) >= 1E-5) {
+          same = false;
+          break;
+        }
+      }
+      if (same) {
+        break;
+      }
+    }
+    if (eng_it == EngineDialValues.size()) {
+      AddEngine(dial_values);
+      ResponsePar.EngineVariation.push_back(var_it);
+    }
+    ResponsePar.VariationEngine.push_back(eng_it);
+  }
+}
+} // namespace
+
 void AddResponseAndDependentDials(
     SystMetaData const &md, std::string const &ResponseDialName,
     std::vector<GSyst_t> const &DependentDials, std::string const &engine_name,
     std::function<GReWeightI *()> EngineInstantiator, bool UseFullHERG,
-    std::vector<GENIEResponseParameter> &param_map) {
+    std::vector<GENIEResponseParameter> &param_map,
+    EventApplicability const &applicability = EventApplicability()) {
 
   std::vector<std::string> DependentDialNames;
   std::transform(DependentDials.begin(), DependentDials.end(),
@@ -43,6 +116,7 @@ void AddResponseAndDependentDials(
     size_t pidx = GetParamIndex(md, ResponseDialName);
     GENIEResponseParameter ResponsePar;
     ResponsePar.pidx = pidx;
+    ResponsePar.applicability = applicability;
 
     for (GSyst_t const &depdial : DependentDials) {
       std::string const &pname = GSyst::AsString(depdial);
@@ -52,33 +126,7 @@ void AddResponseAndDependentDials(
       ResponsePar.dependents.push_back({depdial, GetParamIndex(md, pname)});
     }
 
-    for (size_t i = 0; i < md[pidx].paramVariations.size(); ++i) {
-      std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-      grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-
-      for (auto const &dep : ResponsePar.dependents) {
-        grw->Systematics().Init(dep.gdial, md[dep.pidx].paramVariations[i]);
-      }
-
-      grw->Reconfigure();
-      ResponsePar.Herg.push_back(std::move(grw));
-      if (!UseFullHERG) {
-        break;
-      }
-    }
-    if (md[pidx].isCorrection) {
-      std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-      grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-
-      for (auto const &dep : ResponsePar.dependents) {
-        grw->Systematics().Init(dep.gdial, md[dep.pidx].centralParamValue);
-      }
-
-      grw->Reconfigure();
-      ResponsePar.Herg.push_back(std::move(grw));
-    }
+    DescribeHERG(md, engine_name, EngineInstantiator, UseFullHERG, ResponsePar);
     param_map.push_back(std::move(ResponsePar));
     // We are ignoring the inter-dependence of the parameters.
   } else if (HasAnyParams(md, DependentDialNames)) {
@@ -90,28 +138,9 @@ void AddResponseAndDependentDials(
       size_t pidx = GetParamIndex(md, pname);
       GENIEResponseParameter DialPar;
       DialPar.pidx = pidx;
+      DialPar.applicability = applicability;
       DialPar.dependents.push_back({depdial, pidx});
-      for (double var : md[pidx].paramVariations) {
-        std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-        grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-        grw->Systematics().Init(depdial, var);
-
-        grw->Reconfigure();
-        DialPar.Herg.push_back(std::move(grw));
-        if (!UseFullHERG) {
-          break;
-        }
-      }
-      if (md[pidx].isCorrection) {
-        std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-        grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-        grw->Systematics().Init(depdial, md[pidx].centralParamValue);
-
-        grw->Reconfigure();
-        DialPar.Herg.push_back(std::move(grw));
-      }
+      DescribeHERG(md, engine_name, EngineInstantiator, UseFullHERG, DialPar);
       param_map.push_back(std::move(DialPar));
     }
   }
@@ -122,7 +151,9 @@ void AddIndependentParameters(SystMetaData const &md,
                               std::string const &engine_name,
                               std::function<GReWeightI *()> EngineInstantiator,
                               bool UseFullHERG,
-                              std::vector<GENIEResponseParameter> &param_map) {
+                              std::vector<GENIEResponseParameter> &param_map,
+                              EventApplicability const &applicability =
+                                  EventApplicability()) {
 
   for (GSyst_t const &dial : Dials) {
     if (!HasParam(md, GSyst::AsString(dial))) {
@@ -131,29 +162,10 @@ void AddIndependentParameters(SystMetaData const &md,
     size_t pidx = GetParamIndex(md, GSyst::AsString(dial));
     GENIEResponseParameter dialPar;
     dialPar.pidx = pidx;
+    dialPar.applicability = applicability;
     dialPar.dependents.push_back({dial, pidx});
 
-    for (double var : md[pidx].paramVariations) {
-      std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-      grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-      grw->Systematics().Init(dial, var);
-
-      grw->Reconfigure();
-      dialPar.Herg.push_back(std::move(grw));
-      if (!UseFullHERG) {
-        break;
-      }
-    }
-    if (md[pidx].isCorrection) {
-      std::unique_ptr<GReWeight> grw = std::make_unique<GReWeight>();
-
-      grw->AdoptWghtCalc(engine_name, EngineInstantiator());
-      grw->Systematics().Init(dial, md[pidx].centralParamValue);
-
-      grw->Reconfigure();
-      dialPar.Herg.push_back(std::move(grw));
-    }
+    DescribeHERG(md, engine_name, EngineInstantiator, UseFullHERG, dialPar);
 
     param_map.push_back(std::move(dialPar));
   }
@@ -167,6 +179,11 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
 
+  // The CCQE calculators only respond to CC QE events.
+  EventApplicability const CCQE(
+      {simb_mode_copy::kQE}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+
   // Add NormCCQE
   AddIndependentParameters(
       QEmd, {kXSecTwkDial_NormCCQE}, "xsec_ccqe_axFF",
@@ -176,7 +193,7 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
         rwccqe->SetMode(GReWeightNuXSecCCQE::kModeNormAndMaShape);
         return rwccqe;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCQE);
 
   // Add MACCQE
   bool MAQEIsShapeOnly = tool_options.get<bool>("MAQEIsShapeOnly", false);
@@ -191,12 +208,13 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
                             : GReWeightNuXSecCCQE::kModeMa);
         return rwccqe;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCQE);
 
   // Add AxFFCCQEShape
   AddIndependentParameters(
       QEmd, {kXSecTwkDial_AxFFCCQEshape}, "xsec_ccqe_axFF",
-      []() { return new GReWeightNuXSecCCQEaxial(); }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecCCQEaxial(); }, UseFullHERG, param_map,
+      CCQE);
 
   // Add ZNormCCQE
   AddIndependentParameters(
@@ -207,7 +225,7 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
         rwccqe->SetMode(GReWeightNuXSecCCQE::kModeZExp);
         return rwccqe;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCQE);
 
   // Add ZExpansion dials
   AddResponseAndDependentDials(
@@ -221,7 +239,7 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
         rwccqe->SetMode(GReWeightNuXSecCCQE::kModeZExp);
         return rwccqe;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCQE);
 
   if (tool_options.get<bool>("AxFFCCQEDipoleToZExp", false)) {
 
@@ -240,10 +258,10 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
         }
         attached_AxFFQEShape = true;
 
-        for (auto &grw : grp.Herg) {
-          grw->AdoptWghtCalc("xsec_ccqe_axFF", new GReWeightNuXSecCCQEaxial());
-          grw->Systematics().Init(kXSecTwkDial_AxFFCCQEshape, 1);
-        }
+        grp.Calculators.push_back({"xsec_ccqe_axFF", []() {
+                                     return new GReWeightNuXSecCCQEaxial();
+                                   }});
+        grp.FixedDials.emplace_back(kXSecTwkDial_AxFFCCQEshape, 1);
       }
       // Only want to add in dipole->z-exp reweighting once
       if (attached_AxFFQEShape) {
@@ -260,15 +278,18 @@ ConfigureQEWeightEngine(SystMetaData const &QEmd,
 
   AddIndependentParameters(
       QEmd, {kXSecTwkDial_VecFFCCQEshape}, "xsec_ccqe_vecFF",
-      []() { return new GReWeightNuXSecCCQEvec; }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecCCQEvec; }, UseFullHERG, param_map,
+      CCQE);
 
   AddIndependentParameters(
       QEmd, {kXSecTwkDial_RPA_CCQE}, "xsec_ccqe_rpa",
-      []() { return new GReWeightNuXSecCCQE; }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecCCQE; }, UseFullHERG, param_map,
+      CCQE);
 
   AddIndependentParameters(
       QEmd, {kXSecTwkDial_CoulombCCQE}, "xsec_ccqe_coulomb",
-      []() { return new GReWeightNuXSecCCQE; }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecCCQE; }, UseFullHERG, param_map,
+      CCQE);
 
   return param_map;
 }
@@ -281,6 +302,9 @@ ConfigureMECWeightEngine(SystMetaData const &MECmd,
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
 
+  EventApplicability MEC;
+  MEC.SetModes({simb_mode_copy::kMEC});
+
   AddIndependentParameters(
       MECmd, {
         kXSecTwkDial_NormCCMEC,
@@ -291,7 +315,8 @@ ConfigureMECWeightEngine(SystMetaData const &MECmd,
         kXSecTwkDial_FracDelta_CCMEC,
         kXSecTwkDial_XSecShape_CCMEC
       },
-      "xsec_mec", []() { return new GReWeightXSecMEC; }, UseFullHERG, param_map);
+      "xsec_mec", []() { return new GReWeightXSecMEC; }, UseFullHERG, param_map,
+      MEC);
 
   return param_map;
 
@@ -305,10 +330,14 @@ ConfigureNCELWeightEngine(SystMetaData const &NCELmd,
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
 
+  EventApplicability const NCEL(
+      {simb_mode_copy::kQE}, {EventApplicability::kNC},
+      EventApplicability::outside_response_t::kDefault);
+
   AddResponseAndDependentDials(
       NCELmd, "NCELVariationResponse",
       {kXSecTwkDial_MaNCEL, kXSecTwkDial_EtaNCEL}, "xsec_NCEl_FF",
-      []() { return new GReWeightNuXSecNCEL; }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecNCEL; }, UseFullHERG, param_map, NCEL);
 
   return param_map;
 }
@@ -321,6 +350,18 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
 
+  EventApplicability const CCRES(
+      {simb_mode_copy::kRes}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+  EventApplicability const NCRES(
+      {simb_mode_copy::kRes}, {EventApplicability::kNC},
+      EventApplicability::outside_response_t::kDefault);
+  EventApplicability RES;
+  RES.SetModes({simb_mode_copy::kRes});
+  // GENIE's non-resonant background is made up of low-W DIS events.
+  EventApplicability NonResBkg;
+  NonResBkg.SetModes({simb_mode_copy::kDIS});
+
   // Add any CCRES parameters
   AddIndependentParameters(
       RESmd, {kXSecTwkDial_NormCCRES}, "xsec_ccres_FF",
@@ -330,7 +371,7 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
         rwccres->SetMode(GReWeightNuXSecCCRES::kModeNormAndMaMvShape);
         return rwccres;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCRES);
 
   bool CCRESIsShapeOnly = tool_options.get<bool>("CCRESIsShapeOnly", false);
   AddResponseAndDependentDials(
@@ -345,7 +386,7 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
                              : GReWeightNuXSecCCRES::kModeMaMv);
         return rwccres;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, CCRES);
 
   AddIndependentParameters(
       RESmd, {kXSecTwkDial_NormNCRES}, "xsec_ncres_FF",
@@ -355,7 +396,7 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
         rwncres->SetMode(GReWeightNuXSecNCRES::kModeNormAndMaMvShape);
         return rwncres;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, NCRES);
 
   bool NCRESIsShapeOnly = tool_options.get<bool>("NCRESIsShapeOnly", false);
   AddResponseAndDependentDials(
@@ -370,7 +411,7 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
                              : GReWeightNuXSecNCRES::kModeMaMv);
         return rwncres;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, NCRES);
 
   AddIndependentParameters(
       RESmd,
@@ -382,20 +423,20 @@ ConfigureRESWeightEngine(SystMetaData const &RESmd,
         kXSecTwkDial_RvbarnCC2pi, kXSecTwkDial_RvbarnNC1pi,
         kXSecTwkDial_RvbarnNC2pi}},
       "xsec_NonResBkg", []() { return new GReWeightNonResonanceBkg(); },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, NonResBkg);
 
   AddIndependentParameters(RESmd,
                            {{kRDcyTwkDial_BR1gamma, kRDcyTwkDial_BR1eta,
                              kRDcyTwkDial_Theta_Delta2Npi}},
                            "xsec_ResDecay",
                            []() { return new GReWeightResonanceDecay(); },
-                           UseFullHERG, param_map);
+                           UseFullHERG, param_map, RES);
 
   AddIndependentParameters(RESmd,
                            {{kRDcyTwkDial_Theta_Delta2NRad}},
                            "xsec_DeltaRad",
                            []() { return new GReWeightDeltaradAngle(); },
-                           UseFullHERG, param_map);
+                           UseFullHERG, param_map, RES);
 
 
   return param_map;
@@ -409,10 +450,13 @@ ConfigureCOHWeightEngine(SystMetaData const &COHmd,
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
 
+  EventApplicability COH;
+  COH.SetModes({simb_mode_copy::kCoh});
+
   AddResponseAndDependentDials(
       COHmd, "COHVariationResponse",
       {kXSecTwkDial_MaCOHpi, kXSecTwkDial_R0COHpi, kXSecTwkDial_NormCCCOHpi, kXSecTwkDial_NormNCCOHpi}, "xsec_COH",
-      []() { return new GReWeightNuXSecCOH; }, UseFullHERG, param_map);
+      []() { return new GReWeightNuXSecCOH; }, UseFullHERG, param_map, COH);
 
   return param_map;
 }
@@ -424,6 +468,9 @@ ConfigureDISWeightEngine(SystMetaData const &DISmd,
   std::vector<GENIEResponseParameter> param_map;
 
   bool UseFullHERG = tool_options.get<bool>("UseFullHERG", false);
+  EventApplicability DIS;
+  DIS.SetModes({simb_mode_copy::kDIS});
+
   bool DISBYIsShapeOnly = tool_options.get<bool>("DISBYIsShapeOnly", false);
   AddResponseAndDependentDials(
       DISmd, "DISBYVariationResponse",
@@ -438,7 +485,7 @@ ConfigureDISWeightEngine(SystMetaData const &DISmd,
                                         : GReWeightNuXSecDIS::kModeABCV12u);
         return rwdis;
       },
-      UseFullHERG, param_map);
+      UseFullHERG, param_map, DIS);
 
   AddResponseAndDependentDials(
       DISmd, "AGKYVariationResponse",
@@ -1,11 +1,13 @@
 #include "nusystematics/systproviders/GENIEReWeight_tool.hh"
 
+#include "nusystematics/systproviders/GENIEAdaptiveSampling.hh"
 #include "nusystematics/systproviders/GENIEReWeightEngineConfig.hh"
 #include "nusystematics/systproviders/GENIEReWeightParamConfig.hh"
 
 #include "systematicstools/utility/printers.hh"
 #include "systematicstools/utility/string_parsers.hh"
 #include "nusystematics/utility/GENIEUtils.hh"
+#include "nusystematics/utility/ScopedGENIEQuiet.hh"
 
 // GENIE
 #include "Framework/GHEP/GHepUtils.h"
@@ -13,17 +15,117 @@
 #include "Framework/Utils/RunOpt.h"
 #include "Framework/Utils/XSecSplineList.h"
 
-#include "TH1.h"
-
+#include <algorithm>
+#include <cmath>
+#include <mutex>
 #include <sstream>
-#include <fstream>
 
 using namespace fhicl;
 using namespace systtools;
 using namespace nusyst;
 
+namespace {
+/// The EventApplicability indices of an event.
+struct EventClass {
+  size_t mode, current, flavour;
+};
+EventClass GetEventClass(EventKinematics const &kin) {
+  return {EventApplicability::ModeIndex(kin.mode),
+          EventApplicability::CurrentIndex(kin.IsCC, kin.IsNC),
+          EventApplicability::FlavourIndex(kin.nu_pdg)};
+}
+EventClass GetEventClass(genie::EventRecord const &gev) {
+  genie::ProcessInfo const &proc = gev.Summary()->ProcInfo();
+  genie::GHepParticle const *ISLep = gev.Probe();
+  return {EventApplicability::ModeIndex(GetSimbMode(gev)),
+          EventApplicability::CurrentIndex(proc.IsWeakCC(), proc.IsWeakNC()),
+          EventApplicability::FlavourIndex(ISLep ? ISLep->Pdg() : 0)};
+}
+bool Applies(GENIEResponseParameter const &GENIEResponse,
+             EventClass const &ec) {
+  return GENIEResponse.applicability.Applies(ec.mode, ec.current, ec.flavour);
+}
+
+ResponseSurrogate::key_t GetSurrogateKey(ResponseSurrogate const &surrogate,
+                                         genie::EventRecord const &gev,
+                                         EventKinematics const &kin) {
+  EventClass ec = GetEventClass(kin);
+  size_t event_class =
+      (((ec.mode * EventApplicability::NCurrents) + ec.current) *
+       EventApplicability::NFlavours) +
+      ec.flavour;
+  // In the order of the surrogate axes.
+  double kinematics[] = {kin.Enu, kin.q0, kin.q3, kin.W};
+  return surrogate.GetKey(event_class, gev.Summary()->InitState().Tgt().Pdg(),
+                          kinematics);
+}
+
+ResponseSurrogate::Axis GetSurrogateAxis(fhicl::ParameterSet const &ps,
+                                         std::string const &key,
+                                         std::vector<double> const &def) {
+  std::vector<double> binning = ps.get<std::vector<double>>(key, def);
+  if ((binning.size() != 3) || (binning[0] < 1) ||
+      !(binning[2] > binning[1])) {
+    throw invalid_ToolConfigurationFHiCL()
+        << "[ERROR]: Expected " << key
+        << " to be specified as [NBins, Min, Max], with at least one bin and "
+           "Max > Min.";
+  }
+  return {size_t(binning[0]), binning[1], binning[2]};
+}
+
+/// Guards writing surrogate diagnostics, as every instance in the process may
+/// write to the same directory.
+std::mutex &GetSurrogateDiagnosticsMutex() {
+  static std::mutex m;
+  return m;
+}
+
+/// Builds the GENIE tune exactly once per process, however many
+/// GENIEReWeight instances are set up and from however many threads.
+void InitializeGENIETune(std::string const &genie_tune_name,
+                         std::string const &evgen_list_name) {
+  std::string expTuneName = nusyst::ExpandEnvVar(genie_tune_name);
+
+  static std::once_flag tune_built;
+  std::call_once(tune_built, [&]() {
+    // Constructor automatically calls grunopt->Init();
+    genie::RunOpt *grunopt = genie::RunOpt::Instance();
+    // SetEventGeneratorList wasn't introduced until R-3
+    std::string expEvtGenListName = nusyst::ExpandEnvVar(evgen_list_name);
+    if (expEvtGenListName != "") {
+      grunopt->SetEventGeneratorList(expEvtGenListName);
+    }
+
+    if (expTuneName != genie_tune_name) {
+      std::cout << "TuneName started as '" << genie_tune_name << "' "
+                << " converted to " << expTuneName << std::endl;
+    }
+
+    // If the XSecSplineList returns a non-empty string as the current tune
+    // name, then genie::RunOpt::BuildTune() has already been called.
+    if (genie::XSecSplineList::Instance()->CurrentTune().empty()) {
+      // We need to build the GENIE tune config
+      std::cout << "Configuring GENIE tune \"" << expTuneName << '\"'
+                << std::endl;
+      grunopt->SetTuneName(expTuneName);
+      grunopt->BuildTune();
+      std::cout << *(grunopt->Tune()) << std::endl;
+    }
+  });
+
+  // It has already been built, so just check consistency
+  std::string current_tune = genie::XSecSplineList::Instance()->CurrentTune();
+  if (expTuneName != current_tune) {
+    std::cout << "[TuneNameMismatch] Requested GENIE tune \"" << expTuneName
+              << "\" does not match previously built tune \"" << current_tune
+              << '\"' << std::endl;
+  }
+}
+} // namespace
+
 GENIEReWeight::GENIEReWeight(ParameterSet const &params)
-    : IGENIESystProvider_tool(params), fHaveReconfiguredOneOfTheHERG(false),
+    : IGENIESystProvider_tool(params), AdaptiveResponseTolerance(1E-3),
       valid_file(nullptr), valid_tree(nullptr) {}
 
 std::string GENIEReWeight::AsString() {
@@ -31,6 +133,14 @@ std::string GENIEReWeight::AsString() {
   return "";
 }
 
+bool GENIEReWeight::SupportsParallelReplicas() const {
+  return !fill_valid_tree &&
+         std::none_of(Surrogates.begin(), Surrogates.end(),
+                      [](std::unique_ptr<ResponseSurrogate> const &surrogate) {
+                        return bool(surrogate);
+                      });
+}
+
 SystMetaData GENIEReWeight::BuildSystMetaData(ParameterSet const &params,
                                               paramId_t firstParamId) {
 
@@ -43,6 +153,40 @@ SystMetaData GENIEReWeight::BuildSystMetaData(ParameterSet const &params,
   bool UseFullHERG = params.get<bool>("UseFullHERG", false);
   tool_options.put("UseFullHERG", UseFullHERG);
 
+  // 0 evaluates every variation with GENIE.
+  tool_options.put("AdaptiveResponseOrder",
+                   params.get<size_t>("AdaptiveResponseOrder", 0));
+  tool_options.put("AdaptiveResponseTolerance",
+                   params.get<double>("AdaptiveResponseTolerance", 1E-3));
+
+  // Experimental, see GENIEEnginePool: more than 1 builds the engines on
+  // that many threads and 0 uses every hardware thread.
+  tool_options.put("NEngineBuildThreads",
+                   params.get<size_t>("NEngineBuildThreads", 1));
+
+  // Share identically configured engines between full-HERG parameters.
+  tool_options.put("CompactFullHERG",
+                   params.get<bool>("CompactFullHERG", false));
+
+  // Response parameters to emulate from a fraction of exactly reweighted
+  // events, see SetupResponseCalculator.
+  tool_options.put("SurrogateParameters",
+                   params.get<std::vector<std::string>>("SurrogateParameters",
+                                                        {}));
+  tool_options.put("SurrogateTrainingFraction",
+                   params.get<double>("SurrogateTrainingFraction", 0.1));
+  tool_options.put("SurrogateMinEntries",
+                   params.get<size_t>("SurrogateMinEntries", 10));
+  for (std::string const &axis :
+       {"SurrogateEnuBinning", "SurrogateQ0Binning", "SurrogateQ3Binning",
+        "SurrogateWBinning"}) {
+    if (params.has_key(axis)) {
+      tool_options.put(axis, params.get<std::vector<double>>(axis));
+    }
+  }
+  tool_options.put("SurrogateDiagnosticsFile",
+                   params.get<std::string>("SurrogateDiagnosticsFile", ""));
+
   std::string genie_tune_name = params.get<std::string>("genie_tune_name",
                                                    "${GENIE_XSEC_TUNE}");
   tool_options.put("genie_tune_name",genie_tune_name);
@@ -124,39 +268,10 @@ bool GENIEReWeight::SetupResponseCalculator(
   std::cout << "[INFO]: genie_tune_name = " << genie_tune_name << std::endl;
   std::cout << "[INFO]: evgen_list_name = " << evgen_list_name << std::endl;
 
-  // Constructor automatically calls grunopt->Init();
-  genie::RunOpt* grunopt = genie::RunOpt::Instance();
-  // SetEventGeneratorList wasn't introduced until R-3
-  std::string expEvtGenListName = nusyst::ExpandEnvVar(evgen_list_name);
-  if ( expEvtGenListName != "" ) {
-    grunopt->SetEventGeneratorList(expEvtGenListName);
-  }
-
-  std::string expTuneName = nusyst::ExpandEnvVar(genie_tune_name);
-  if ( expTuneName != genie_tune_name ) {
-    std::cout << "TuneName started as '" << genie_tune_name << "' "
-                             << " converted to " << expTuneName << std::endl;;
-  }
+  InitializeGENIETune(genie_tune_name, evgen_list_name);
 
-  // If the XSecSplineList returns a non-empty string as the current tune name,
-  // then genie::RunOpt::BuildTune() has already been called.
-  std::string current_tune = genie::XSecSplineList::Instance()->CurrentTune();
-  if ( current_tune.empty() ) {
-    // We need to build the GENIE tune config
-      std::cout << "Configuring GENIE tune \""
-        << expTuneName << '\"' << std::endl;;
-      grunopt->SetTuneName( expTuneName );
-      grunopt->BuildTune();
-      std::cout << *(grunopt->Tune()) << std::endl;
-    }
-    else {
-      // It has already been built, so just check consistency
-      if ( expTuneName != current_tune) {
-        std::cout << "[TuneNameMismatch] Requested GENIE tune \""
-          << expTuneName << "\" does not match previously built tune \""
-          << current_tune << '\"' << std::endl;
-      }
-    }
+  // Setup is serial, unlike the CalcWeight loops that silence std::cout.
+  ScopedGENIEQuiet::Install();
 
   // Quiet mode
   genie::Messenger::Instance()->SetPrioritiesFromXmlFile(
@@ -186,13 +301,100 @@ bool GENIEReWeight::SetupResponseCalculator(
   extend_ResponseToGENIEParameters(
       ConfigureOtherWeightEngine(GetSystMetaData(), tool_options));
 
+  size_t AdaptiveResponseOrder =
+      tool_options.get<size_t>("AdaptiveResponseOrder", 0);
+  if (AdaptiveResponseOrder > kMaxAdaptiveResponseOrder) {
+    throw invalid_ToolConfigurationFHiCL()
+        << "[ERROR]: AdaptiveResponseOrder = " << AdaptiveResponseOrder
+        << ", but response polynomials of at most order "
+        << kMaxAdaptiveResponseOrder << " are supported.";
+  }
+  AdaptiveResponseTolerance =
+      tool_options.get<double>("AdaptiveResponseTolerance", 1E-3);
+  for (GENIEResponseParameter &GENIEResponse : ResponseToGENIEParameters) {
+    PlanAdaptiveSampling(GENIEResponse, GetSystMetaData(),
+                         AdaptiveResponseOrder);
+  }
+
+  size_t NEngineBuildThreads =
+      tool_options.get<size_t>("NEngineBuildThreads", 1);
+  bool CompactFullHERG = tool_options.get<bool>("CompactFullHERG", false);
+  EnginePool = std::make_unique<GENIEEnginePool>(
+      ResponseToGENIEParameters, NEngineBuildThreads, CompactFullHERG);
+  // Build the engines for the configuring thread now, so that any GENIE
+  // configuration problems surface during setup.
+  GENIEEngineSet const &engines = EnginePool->Get();
+  for (auto const &bs : engines.BuildStats) {
+    std::cout << "[INFO]: Built " << bs.second.NEngines << " " << bs.first
+              << " engine(s) in " << bs.second.Seconds << " s";
+    if (bs.second.NShared) {
+      std::cout << ", shared " << bs.second.NShared << " more";
+    }
+    if (bs.second.NMeasured) {
+      std::cout << ", RSS +" << (double(bs.second.RSSBytes) / (1 << 20))
+                << " MB over " << bs.second.NMeasured << " serially built";
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "[INFO]: Built GENIE ReWeight engines in "
+            << engines.BuildSeconds << " s, RSS +"
+            << (double(engines.RSSBytes) / (1 << 20)) << " MB" << std::endl;
+
   std::cout << "[INFO]: Done!" << std::endl;
 
+  CalcWeightTraceNames.clear();
+  for (GENIEResponseParameter const &resp : ResponseToGENIEParameters) {
+    CalcWeightTraceNames.push_back(nusyst::ResponseTracer::Get().Intern(
+        "GReWeight::CalcWeight " + GetSystMetaData()[resp.pidx].prettyName));
+  }
+
   fill_valid_tree = tool_options.get("fill_valid_tree", false);
   if (fill_valid_tree) {
     InitValidTree();
   }
 
+  // Each surrogate parameter is binned in Enu, q0, q3 and W (all GeV), as
+  // well as by interaction mode, current, neutrino flavour and target. The
+  // default binning has ~10^3 kinematic bins per event class, many of them
+  // unphysical, so that a sample of O(10^5) events per class trains most
+  // populated bins with the default training fraction and minimum entries.
+  Surrogates.clear();
+  Surrogates.resize(ResponseToGENIEParameters.size());
+  SurrogateDiagnosticsFile =
+      tool_options.get<std::string>("SurrogateDiagnosticsFile", "");
+  std::vector<ResponseSurrogate::Axis> SurrogateAxes{
+      GetSurrogateAxis(tool_options, "SurrogateEnuBinning", {8, 0, 8}),
+      GetSurrogateAxis(tool_options, "SurrogateQ0Binning", {6, 0, 3}),
+      GetSurrogateAxis(tool_options, "SurrogateQ3Binning", {6, 0, 3}),
+      GetSurrogateAxis(tool_options, "SurrogateWBinning", {4, 0.5, 2.5})};
+  double SurrogateTrainingFraction =
+      tool_options.get<double>("SurrogateTrainingFraction", 0.1);
+  size_t SurrogateMinEntries =
+      tool_options.get<size_t>("SurrogateMinEntries", 10);
+  for (std::string const &name : tool_options.get<std::vector<std::string>>(
+           "SurrogateParameters", {})) {
+    size_t resp_idx = 0;
+    for (; resp_idx < ResponseToGENIEParameters.size(); ++resp_idx) {
+      if (GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx]
+              .prettyName == name) {
+        break;
+      }
+    }
+    if (resp_idx == ResponseToGENIEParameters.size()) {
+      throw invalid_ToolConfigurationFHiCL()
+          << "[ERROR]: SurrogateParameters contains \"" << name
+          << "\", which is not a configured GENIE response parameter.";
+    }
+    SystParamHeader const &hdr =
+        GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx];
+    Surrogates[resp_idx] = std::make_unique<ResponseSurrogate>(
+        hdr.isCorrection ? 1 : hdr.paramVariations.size(), SurrogateAxes,
+        SurrogateTrainingFraction, SurrogateMinEntries);
+    std::cout << "[INFO]: Emulating responses to " << name
+              << " after training on " << (SurrogateTrainingFraction * 100)
+              << "% of events." << std::endl;
+  }
+
   genie::Messenger::Instance()->SetPrioritiesFromXmlFile(
       "Messenger_whisper.xml");
   return true;
@@ -210,29 +412,77 @@ GENIEReWeight::GetEventResponse(genie::EventRecord const &gev) {
     event_responses.push_back(GetEventGENIEParameterResponse(gev, resp_idx));
   }
   if (fill_valid_tree) {
-    TLorentzVector FSLepP4 = gev.Summary()->Kine().FSLeptonP4();
-    TLorentzVector ISLepP4 =
-        *gev.Summary()->InitState().GetProbeP4(genie::kRfLab);
-    TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-
-    Pdgnu = gev.Summary()->InitState().ProbePdg();
-    NEUTMode = 0;
-    if (gev.Summary()->ProcInfo().IsMEC() &&
-        gev.Summary()->ProcInfo().IsWeakCC()) {
-      NEUTMode = (Pdgnu > 0) ? 2 : -2;
+    FillValidTree(gev);
+  }
+
+  return event_responses;
+}
+
+void GENIEReWeight::FillEventResponse(genie::EventRecord const &gev,
+                                      EventKinematics const &kin,
+                                      EventResponseArena &arena) {
+
+  size_t NResps = ResponseToGENIEParameters.size();
+  size_t mode_idx = EventApplicability::ModeIndex(kin.mode);
+  EventClass ec = GetEventClass(kin);
+
+  GENIEEngineSet &engines = EnginePool->Get();
+  ScopedGENIEQuiet quiet;
+
+  for (size_t resp_idx = 0; resp_idx < NResps; ++resp_idx) {
+    SystParamHeader const &hdr =
+        GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx];
+    systtools::paramId_t pid = hdr.systParamId;
+
+    ResponseProfiler::clock::time_point start;
+    if (profiler) {
+      start = ResponseProfiler::clock::now();
+    }
+
+    double *responses = arena.OpenParameter(pid);
+    if (!Applies(ResponseToGENIEParameters[resp_idx], ec)) {
+      // GENIE would just return 1 for every variation
+      std::fill_n(responses,
+                  hdr.isCorrection ? 1 : hdr.paramVariations.size(), 1);
+    } else if (Surrogates[resp_idx]) {
+      if (FillSurrogateParameterResponse(gev, kin, resp_idx, responses,
+                                         engines)) {
+        arena.SetEmulated(arena.GetSlot(pid));
+      }
     } else {
-      NEUTMode = genie::utils::ghep::NeutReactionCode(&gev);
+      FillEventGENIEParameterResponse(gev, resp_idx, responses, engines);
     }
 
-    Enu = ISLepP4.E();
-    Q2 = -emTransfer.Mag2();
-    W = gev.Summary()->Kine().W(true);
-    q0 = emTransfer.E();
-    q3 = emTransfer.Vect().Mag();
-    valid_tree->Fill();
+    if (profiler) {
+      profiler->RecordParameter(pid, mode_idx, start);
+    }
   }
+  if (fill_valid_tree) {
+    FillValidTree(gev);
+  }
+}
 
-  return event_responses;
+void GENIEReWeight::FillValidTree(genie::EventRecord const &gev) {
+  TLorentzVector FSLepP4 = gev.Summary()->Kine().FSLeptonP4();
+  TLorentzVector ISLepP4 =
+      *gev.Summary()->InitState().GetProbeP4(genie::kRfLab);
+  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
+
+  Pdgnu = gev.Summary()->InitState().ProbePdg();
+  NEUTMode = 0;
+  if (gev.Summary()->ProcInfo().IsMEC() &&
+      gev.Summary()->ProcInfo().IsWeakCC()) {
+    NEUTMode = (Pdgnu > 0) ? 2 : -2;
+  } else {
+    NEUTMode = genie::utils::ghep::NeutReactionCode(&gev);
+  }
+
+  Enu = ISLepP4.E();
+  Q2 = -emTransfer.Mag2();
+  W = gev.Summary()->Kine().W(true);
+  q0 = emTransfer.E();
+  q3 = emTransfer.Vect().Mag();
+  valid_tree->Fill();
 }
 
 double GENIEReWeight::GetEventWeightResponse(
@@ -241,9 +491,16 @@ double GENIEReWeight::GetEventWeightResponse(
 
   double weight = 1;
 
-  fHaveReconfiguredOneOfTheHERG = true;
+  GENIEEngineSet &engines = EnginePool->Get();
+  engines.HaveReconfiguredOneOfTheHERG = true;
 
-  for (auto &GENIEResponse : ResponseToGENIEParameters) {
+  ScopedGENIEQuiet quiet;
+
+  for (size_t resp_idx = 0; resp_idx < ResponseToGENIEParameters.size();
+       ++resp_idx) {
+    GENIEResponseParameter const &GENIEResponse =
+        ResponseToGENIEParameters[resp_idx];
+    genie::rew::GReWeight &engine = *engines.Hergs[resp_idx].front();
     for (auto const &dep : GENIEResponse.dependents) {
       SystParamHeader const &hdr = GetSystMetaData()[dep.pidx];
       double pval = hdr.centralParamValue;
@@ -251,16 +508,16 @@ double GENIEReWeight::GetEventWeightResponse(
         pval = GetParamElementFromContainer(set_params, dep.pidx).val;
       }
 
-      GENIEResponse.Herg.front()->Systematics().Set(dep.gdial, pval);
-    }
-    GENIEResponse.Herg.front()->Reconfigure();
-    bool is_set_dir = TH1::AddDirectoryStatus();
-    if (!is_set_dir) {
-      TH1::AddDirectory(true);
+      engine.Systematics().Set(dep.gdial, pval);
     }
-    weight *= GENIEResponse.Herg.front()->CalcWeight(gev);
-    if (!is_set_dir) {
-      TH1::AddDirectory(false);
+    engine.Reconfigure();
+    weight *= engine.CalcWeight(gev);
+
+    // The engine may be shared with another parameter's HERG, which must not
+    // see these dial values when it next reconfigures it.
+    for (size_t d_it = 0; d_it < GENIEResponse.dependents.size(); ++d_it) {
+      engine.Systematics().Set(GENIEResponse.dependents[d_it].gdial,
+                               GENIEResponse.EngineDialValues[0][d_it]);
     }
   }
 
@@ -283,30 +540,35 @@ GENIEReWeight::GetEventResponse(genie::EventRecord const &gev,
   return systtools::event_unit_response_t();
 }
 
-namespace {
-std::streambuf *default_cout;
-std::ofstream redirect_stream("/dev/null");
-} // namespace
-
 systtools::ParamResponses
 GENIEReWeight::GetEventGENIEParameterResponse(genie::EventRecord const &gev,
                                               size_t idx) {
 
-  GENIEResponseParameter &GENIEResponse = ResponseToGENIEParameters[idx];
-  systtools::SystParamHeader const &hdr = GetSystMetaData()[GENIEResponse.pidx];
-
-  size_t NVars = hdr.isCorrection ? 1 : hdr.paramVariations.size();
-#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
-  std::cout << "[INFO]: Resp dial: " << hdr.prettyName << " with " << NVars
-            << " variations of " << GENIEResponse.dependents.size()
-            << " dependent parameters." << std::endl;
-#endif
+  systtools::SystParamHeader const &hdr =
+      GetSystMetaData()[ResponseToGENIEParameters[idx].pidx];
+
+  ParamResponses presp{
+      hdr.systParamId,
+      std::vector<double>(hdr.isCorrection ? 1 : hdr.paramVariations.size(),
+                          1)};
+  if (Applies(ResponseToGENIEParameters[idx], GetEventClass(gev))) {
+    GENIEEngineSet &engines = EnginePool->Get();
+    ScopedGENIEQuiet quiet;
+    if (Surrogates[idx]) {
+      FillSurrogateParameterResponse(gev, BuildEventKinematics(gev), idx,
+                                     presp.responses.data(), engines);
+    } else {
+      FillEventGENIEParameterResponse(gev, idx, presp.responses.data(),
+                                      engines);
+    }
+  }
 
-  // Have one GENIEReWeight per response rather than per variation, must
-  // reconfigure.
-  bool IsReducedHERG = (NVars > GENIEResponse.Herg.size());
+  return presp;
+}
 
-  if (fHaveReconfiguredOneOfTheHERG && !IsReducedHERG) {
+void GENIEReWeight::CheckHERGState(GENIEEngineSet const &engines,
+                                   bool IsReducedHERG) {
+  if (engines.HaveReconfiguredOneOfTheHERG && !IsReducedHERG) {
     throw invalid_engine_state()
         << "[ERROR]: GENIEReWeight_tool is configured to instantiate and "
            "Reconfigure one GENIE genie::GReWeight per variation. Because this "
@@ -317,41 +579,110 @@ GENIEReWeight::GetEventGENIEParameterResponse(genie::EventRecord const &gev,
            "calculating the pre-configured event responses via "
            "GetEventResponse.";
   }
+}
+
+void GENIEReWeight::ConfigureReducedHERG(
+    GENIEResponseParameter const &GENIEResponse, HERG_t &Herg, size_t var_it) {
+  for (auto const &dep : GENIEResponse.dependents) {
+    SystParamHeader const &hdr = GetSystMetaData()[dep.pidx];
+    Herg.front()->Systematics().Set(
+        dep.gdial, hdr.isCorrection ? hdr.centralParamValue
+                                    : hdr.paramVariations[var_it]);
+#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
+    std::cout << "\t\t Var = "
+              << (hdr.isCorrection ? hdr.centralParamValue
+                                   : hdr.paramVariations[var_it])
+              << " GDial: " << genie::rew::GSyst::AsString(dep.gdial)
+              << " at "
+              << Herg.front()
+                     ->Systematics()
+                     .Info(dep.gdial)
+                     ->CurValue
+              << std::endl;
+#endif
+  }
+  Herg.front()->Reconfigure();
+}
 
-  ParamResponses presp{hdr.systParamId, {}};
+bool GENIEReWeight::FillSurrogateParameterResponse(
+    genie::EventRecord const &gev, EventKinematics const &kin, size_t idx,
+    double *responses, GENIEEngineSet &engines) {
+  ResponseSurrogate &surrogate = *Surrogates[idx];
+  ResponseSurrogate::key_t key = GetSurrogateKey(surrogate, gev, kin);
+  {
+    std::lock_guard<std::mutex> lock(SurrogateMutex);
+    if (surrogate.Emulate(key, responses)) {
+      return true;
+    }
+  }
+  FillEventGENIEParameterResponse(gev, idx, responses, engines);
+  std::lock_guard<std::mutex> lock(SurrogateMutex);
+  surrogate.Train(key, responses);
+  return false;
+}
 
-  for (size_t var_it = 0; var_it < NVars; ++var_it) {
+double GENIEReWeight::CalcVariationWeight(genie::EventRecord const &gev,
+                                          size_t idx, size_t var_it,
+                                          HERG_t &Herg) {
+  GENIEResponseParameter const &GENIEResponse = ResponseToGENIEParameters[idx];
+  genie::rew::GReWeight *engine = nullptr;
+  if (GENIEResponse.IsReducedHERG()) {
+    ConfigureReducedHERG(GENIEResponse, Herg, var_it);
+    engine = Herg.front().get();
+  } else {
+    engine = Herg[GENIEResponse.VariationEngine[var_it]].get();
+  }
+  nusyst::TraceSpan span(CalcWeightTraceNames[idx], int32_t(var_it));
+  return engine->CalcWeight(gev);
+}
 
-    if (IsReducedHERG) { // Need a reconfigure for each variation
-      for (auto const &dep : GENIEResponse.dependents) {
-        SystParamHeader const &hdr = GetSystMetaData()[dep.pidx];
-        GENIEResponse.Herg.front()->Systematics().Set(
-            dep.gdial, hdr.isCorrection ? hdr.centralParamValue
-                                        : hdr.paramVariations[var_it]);
-#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
-        std::cout << "\t\t Var = "
-                  << (hdr.isCorrection ? hdr.centralParamValue
-                                       : hdr.paramVariations[var_it])
-                  << " GDial: " << genie::rew::GSyst::AsString(dep.gdial)
-                  << " at "
-                  << GENIEResponse.Herg.front()
-                         ->Systematics()
-                         .Info(dep.gdial)
-                         ->CurValue
-                  << std::endl;
+void GENIEReWeight::FillEventGENIEParameterResponse(
+    genie::EventRecord const &gev, size_t idx, double *responses,
+    GENIEEngineSet &engines) {
 
+  GENIEResponseParameter const &GENIEResponse = ResponseToGENIEParameters[idx];
+  HERG_t &Herg = engines.Hergs[idx];
+  systtools::SystParamHeader const &hdr = GetSystMetaData()[GENIEResponse.pidx];
+
+  size_t NVars = hdr.isCorrection ? 1 : hdr.paramVariations.size();
+#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
+  std::cout << "[INFO]: Resp dial: " << hdr.prettyName << " with " << NVars
+            << " variations of " << GENIEResponse.dependents.size()
+            << " dependent parameters." << std::endl;
 #endif
+
+  // Have one GENIEReWeight per response rather than per variation, must
+  // reconfigure.
+  bool IsReducedHERG = GENIEResponse.IsReducedHERG();
+  CheckHERGState(engines, IsReducedHERG);
+
+  // Only fall through to evaluating every variation if the polynomial
+  // through the fit variations misses the check variation.
+  bool Sampled = GENIEResponse.IsAdaptive();
+  if (Sampled) {
+    for (size_t var_it = 0; var_it < NVars; ++var_it) {
+      if (GENIEResponse.IsSampledVariation[var_it]) {
+        responses[var_it] = CalcVariationWeight(gev, idx, var_it, Herg);
       }
-      GENIEResponse.Herg.front()->Reconfigure();
-      bool is_set_dir = TH1::AddDirectoryStatus();
-      if (!is_set_dir) {
-        TH1::AddDirectory(true);
-      }
-      presp.responses.push_back(GENIEResponse.Herg.front()->CalcWeight(gev));
-      if (!is_set_dir) {
-        TH1::AddDirectory(false);
-      }
+    }
+    if (FillFromResponsePolynomial(
+            GENIEResponse, hdr, AdaptiveResponseTolerance,
+            [&](size_t var_it) -> double & { return responses[var_it]; })) {
+      return;
+    }
+  }
+
+  for (size_t var_it = 0; var_it < NVars; ++var_it) {
+    if (Sampled && GENIEResponse.IsSampledVariation[var_it]) {
+      continue;
+    }
+
+    if (IsReducedHERG) { // Need a reconfigure for each variation
+      ConfigureReducedHERG(GENIEResponse, Herg, var_it);
+      nusyst::TraceSpan span(CalcWeightTraceNames[idx], int32_t(var_it));
+      responses[var_it] = Herg.front()->CalcWeight(gev);
     } else { // Is full HERG, no reconfigure needed
+      size_t eng_it = GENIEResponse.VariationEngine[var_it];
 #ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
       for (GENIEResponseParameter::DependentParameter const &dep :
            GENIEResponse.dependents) {
@@ -361,7 +692,7 @@ GENIEReWeight::GetEventGENIEParameterResponse(genie::EventRecord const &gev,
                                        : hdr.paramVariations[var_it])
                   << " GDial: " << genie::rew::GSyst::AsString(dep.gdial)
                   << " at "
-                  << GENIEResponse.Herg[var_it]
+                  << Herg[eng_it]
                          ->Systematics()
                          .Info(dep.gdial)
                          ->CurValue
@@ -369,42 +700,186 @@ GENIEReWeight::GetEventGENIEParameterResponse(genie::EventRecord const &gev,
       }
 #endif
 
-      // As some GENIE dials are very slow, it is worth checking if we have
-      // already calculated this variation before
-      size_t pindx = std::numeric_limits<size_t>::max();
-      for (size_t v_it = 0; v_it < var_it; ++v_it) {
-        if (fabs(hdr.paramVariations[v_it] - hdr.paramVariations[var_it]) <
-            1E-5) {
-          pindx = v_it;
-          break;
+      // Variations that share an engine were found at setup, only the first
+      // of them needs to be calculated.
+      size_t first_var = GENIEResponse.EngineVariation[eng_it];
+      if (first_var != var_it) {
+        responses[var_it] = responses[first_var];
+      } else { // must calculate
+        nusyst::TraceSpan span(CalcWeightTraceNames[idx], int32_t(var_it));
+        responses[var_it] = Herg[eng_it]->CalcWeight(gev);
+      }
+    }
+#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
+    std::cout << "\t -> " << responses[var_it] << std::endl;
+#endif
+  }
+}
+
+void GENIEReWeight::GetEventResponses(
+    std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+    EventResponseBlock &block) {
+
+  size_t NEvs = gheps.size();
+  size_t NResps = ResponseToGENIEParameters.size();
+
+  std::vector<EventClass> ecs;
+  for (auto const &gev : gheps) {
+    ecs.push_back(GetEventClass(*gev));
+  }
+  std::vector<EventKinematics> kins;
+  if (std::any_of(Surrogates.begin(), Surrogates.end(),
+                  [](std::unique_ptr<ResponseSurrogate> const &surrogate) {
+                    return bool(surrogate);
+                  })) {
+    for (auto const &gev : gheps) {
+      kins.push_back(BuildEventKinematics(*gev));
+    }
+  }
+
+  GENIEEngineSet &engines = EnginePool->Get();
+  ScopedGENIEQuiet quiet;
+
+  // Variation-major: each engine configuration is used for the whole batch,
+  // so that a reduced HERG only needs one Reconfigure per variation per
+  // batch, rather than one per variation per event.
+  for (size_t resp_idx = 0; resp_idx < NResps; ++resp_idx) {
+    GENIEResponseParameter const &GENIEResponse =
+        ResponseToGENIEParameters[resp_idx];
+    HERG_t &Herg = engines.Hergs[resp_idx];
+    SystParamHeader const &hdr = GetSystMetaData()[GENIEResponse.pidx];
+    size_t bidx = block.GetParameterIndex(hdr.systParamId);
+
+    size_t NVars = hdr.isCorrection ? 1 : hdr.paramVariations.size();
+    bool IsReducedHERG = GENIEResponse.IsReducedHERG();
+    CheckHERGState(engines, IsReducedHERG);
+
+    std::vector<bool> applies(NEvs);
+    bool any_applies = false;
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      applies[ev_it] = Applies(GENIEResponse, ecs[ev_it]);
+      any_applies = any_applies || applies[ev_it];
+    }
+
+    // The events that still need GENIE, every other event has had all of its
+    // responses to this parameter filled.
+    std::vector<bool> evaluate(applies);
+    bool any_evaluate = any_applies;
+
+    // Emulated events are filled up front and need no GENIE calls at all.
+    std::vector<ResponseSurrogate::key_t> keys;
+    std::vector<bool> emulated_ev(NEvs, false);
+    if (Surrogates[resp_idx] && any_applies) {
+      ResponseSurrogate &surrogate = *Surrogates[resp_idx];
+      std::vector<double> emulated(NVars);
+      any_evaluate = false;
+      std::lock_guard<std::mutex> lock(SurrogateMutex);
+      for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+        keys.push_back(GetSurrogateKey(surrogate, *gheps[ev_it], kins[ev_it]));
+        if (!applies[ev_it] ||
+            !surrogate.Emulate(keys.back(), emulated.data())) {
+          any_evaluate = any_evaluate || evaluate[ev_it];
+          continue;
+        }
+        for (size_t var_it = 0; var_it < NVars; ++var_it) {
+          block.GetResponses(bidx, var_it)[ev_it] = emulated[var_it];
         }
+        evaluate[ev_it] = false;
+        emulated_ev[ev_it] = true;
+        block.SetEmulated(bidx, ev_it);
       }
-      if (pindx !=
-          std::numeric_limits<size_t>::max()) { // Have already calculated this
-        // value, just use that
-        presp.responses.push_back(presp.responses[pindx]);
-      } else { // must calculate
-        bool is_set_dir = TH1::AddDirectoryStatus();
-        if (!is_set_dir) {
-          TH1::AddDirectory(true);
+    }
+
+    auto FillVariation = [&](size_t var_it, bool sampling) {
+      double *responses = block.GetResponses(bidx, var_it);
+
+      genie::rew::GReWeight *engine = nullptr;
+      if (IsReducedHERG) {
+        // No need to configure the engine if no event in the batch needs
+        // GENIE.
+        if (any_evaluate) {
+          ConfigureReducedHERG(GENIEResponse, Herg, var_it);
+          engine = Herg.front().get();
+        }
+      } else {
+        size_t eng_it = GENIEResponse.VariationEngine[var_it];
+        size_t first_var = GENIEResponse.EngineVariation[eng_it];
+        // While sampling, only the sampled variations have been filled.
+        if ((first_var != var_it) &&
+            (!sampling || GENIEResponse.IsSampledVariation[first_var])) {
+          std::copy_n(block.GetResponses(bidx, first_var), NEvs, responses);
+          return;
+        }
+        engine = Herg[eng_it].get();
+      }
+
+      for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+        if (!applies[ev_it]) {
+          responses[ev_it] = 1;
+          continue;
+        }
+        if (!evaluate[ev_it]) {
+          continue;
+        }
+        nusyst::TraceSpan span(CalcWeightTraceNames[resp_idx],
+                               int32_t(var_it));
+        responses[ev_it] = engine->CalcWeight(*gheps[ev_it]);
+      }
+    };
+
+    // Evaluate the sampled variations for the whole batch, then only go back
+    // to GENIE for the other variations of events whose polynomial failed the
+    // check.
+    bool Sampling = GENIEResponse.IsAdaptive() && any_evaluate;
+    if (Sampling) {
+      for (size_t var_it = 0; var_it < NVars; ++var_it) {
+        if (GENIEResponse.IsSampledVariation[var_it]) {
+          FillVariation(var_it, true);
+        }
+      }
+      any_evaluate = false;
+      for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+        if (!evaluate[ev_it]) {
+          continue;
         }
+        evaluate[ev_it] = !FillFromResponsePolynomial(
+            GENIEResponse, hdr, AdaptiveResponseTolerance,
+            [&](size_t var_it) -> double & {
+              return block.GetResponses(bidx, var_it)[ev_it];
+            });
+        any_evaluate = any_evaluate || evaluate[ev_it];
+      }
+    }
 
-        ::default_cout = std::cout.rdbuf();
-        std::cout.rdbuf(::redirect_stream.rdbuf());
-        presp.responses.push_back(GENIEResponse.Herg[var_it]->CalcWeight(gev));
-        std::cout.rdbuf(::default_cout);
+    for (size_t var_it = 0; var_it < NVars; ++var_it) {
+      if (Sampling && GENIEResponse.IsSampledVariation[var_it]) {
+        continue;
+      }
+      FillVariation(var_it, false);
+    }
 
-        if (!is_set_dir) {
-          TH1::AddDirectory(false);
+    if (keys.size()) {
+      ResponseSurrogate &surrogate = *Surrogates[resp_idx];
+      std::vector<double> calculated(NVars);
+      std::lock_guard<std::mutex> lock(SurrogateMutex);
+      for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+        if (!applies[ev_it] || emulated_ev[ev_it]) {
+          continue;
+        }
+        for (size_t var_it = 0; var_it < NVars; ++var_it) {
+          calculated[var_it] = block.GetResponses(bidx, var_it)[ev_it];
         }
+        surrogate.Train(keys[ev_it], calculated.data());
       }
     }
-#ifdef GENIEREWEIGHT_GETEVENTRESPONSE_DEBUG
-    std::cout << "\t -> " << presp.responses.back() << std::endl;
-#endif
+    block.SetHandled(bidx);
   }
 
-  return presp;
+  if (fill_valid_tree) {
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      FillValidTree(*gheps[ev_it]);
+    }
+  }
 }
 
 void GENIEReWeight::InitValidTree() {
@@ -422,7 +897,117 @@ void GENIEReWeight::InitValidTree() {
   valid_tree->Branch("weights", &weights);
 }
 
+std::vector<systtools::paramId_t> GENIEReWeight::GetEmulatedParameters() const {
+  std::vector<systtools::paramId_t> pids;
+  for (size_t resp_idx = 0; resp_idx < Surrogates.size(); ++resp_idx) {
+    if (Surrogates[resp_idx]) {
+      pids.push_back(
+          GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx]
+              .systParamId);
+    }
+  }
+  return pids;
+}
+
+void GENIEReWeight::WriteDiagnostics(TDirectory *dir) {
+  if (!Surrogates.size()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(GetSurrogateDiagnosticsMutex());
+  WriteSurrogateDiagnostics(dir);
+}
+
+void GENIEReWeight::WriteSurrogateDiagnostics(TDirectory *dir) {
+  // Every instance writing to the same directory appends its rows to the tree
+  // written by the first one.
+  TTree *diag_tree = nullptr;
+  dir->GetObject("surrogate_diagnostics", diag_tree);
+
+  std::string provider = GetFullyQualifiedName(), name;
+  std::string *provider_ptr = &provider, *name_ptr = &name;
+  Long64_t NTrain, NEmulated, NChecked, NFilledBins;
+  double MeanResidual, RMSResidual, MaxAbsResidual;
+  if (diag_tree) {
+    diag_tree->SetBranchAddress("provider", &provider_ptr);
+    diag_tree->SetBranchAddress("name", &name_ptr);
+    diag_tree->SetBranchAddress("NTrain", &NTrain);
+    diag_tree->SetBranchAddress("NEmulated", &NEmulated);
+    diag_tree->SetBranchAddress("NChecked", &NChecked);
+    diag_tree->SetBranchAddress("NFilledBins", &NFilledBins);
+    diag_tree->SetBranchAddress("MeanResidual", &MeanResidual);
+    diag_tree->SetBranchAddress("RMSResidual", &RMSResidual);
+    diag_tree->SetBranchAddress("MaxAbsResidual", &MaxAbsResidual);
+  } else {
+    diag_tree = new TTree("surrogate_diagnostics", "");
+    diag_tree->SetDirectory(dir);
+    diag_tree->Branch("provider", &provider_ptr);
+    diag_tree->Branch("name", &name_ptr);
+    diag_tree->Branch("NTrain", &NTrain);
+    diag_tree->Branch("NEmulated", &NEmulated);
+    diag_tree->Branch("NChecked", &NChecked);
+    diag_tree->Branch("NFilledBins", &NFilledBins);
+    diag_tree->Branch("MeanResidual", &MeanResidual);
+    diag_tree->Branch("RMSResidual", &RMSResidual);
+    diag_tree->Branch("MaxAbsResidual", &MaxAbsResidual);
+  }
+
+  for (size_t resp_idx = 0; resp_idx < Surrogates.size(); ++resp_idx) {
+    if (!Surrogates[resp_idx]) {
+      continue;
+    }
+    ResponseSurrogate::Diagnostics const &diag =
+        Surrogates[resp_idx]->GetDiagnostics();
+    name = GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx]
+               .prettyName;
+    NTrain = diag.NTrain;
+    NEmulated = diag.NEmulated;
+    NChecked = diag.NChecked;
+    NFilledBins = Surrogates[resp_idx]->GetNFilledBins();
+    MeanResidual = diag.MeanResidual();
+    RMSResidual = diag.RMSResidual();
+    MaxAbsResidual = diag.MaxAbsResidual;
+    diag_tree->Fill();
+  }
+
+  dir->WriteTObject(diag_tree, "", "Overwrite");
+  // Read back by the next instance writing to dir.
+  delete diag_tree;
+}
+
+void GENIEReWeight::PrintSurrogateDiagnostics() {
+  for (size_t resp_idx = 0; resp_idx < Surrogates.size(); ++resp_idx) {
+    if (!Surrogates[resp_idx]) {
+      continue;
+    }
+    ResponseSurrogate::Diagnostics const &diag =
+        Surrogates[resp_idx]->GetDiagnostics();
+    std::cout << "[INFO]: Surrogate "
+              << GetSystMetaData()[ResponseToGENIEParameters[resp_idx].pidx]
+                     .prettyName
+              << " emulated " << diag.NEmulated << " and calculated "
+              << diag.NTrain << " events in "
+              << Surrogates[resp_idx]->GetNFilledBins()
+              << " bins. Emulation residuals over " << diag.NChecked
+              << " checked events: mean = " << diag.MeanResidual()
+              << ", RMS = " << diag.RMSResidual()
+              << ", max |r| = " << diag.MaxAbsResidual << std::endl;
+  }
+}
+
 GENIEReWeight::~GENIEReWeight() {
+  if (Surrogates.size()) {
+    PrintSurrogateDiagnostics();
+  }
+  if (Surrogates.size() && SurrogateDiagnosticsFile.size()) {
+    // The first instance in the process to write to the file recreates it.
+    static std::set<std::string> diag_files;
+    std::lock_guard<std::mutex> lock(GetSurrogateDiagnosticsMutex());
+    bool IsFirst = diag_files.insert(SurrogateDiagnosticsFile).second;
+    TFile diag_file(SurrogateDiagnosticsFile.c_str(),
+                    IsFirst ? "RECREATE" : "UPDATE");
+    WriteSurrogateDiagnostics(&diag_file);
+    diag_file.Close();
+  }
   if (valid_file) {
     valid_tree->SetDirectory(valid_file);
     valid_file->Write();
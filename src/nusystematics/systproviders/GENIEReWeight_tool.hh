@@ -2,8 +2,11 @@
 
 #include "nusystematics/interface/IGENIESystProvider_tool.hh"
 
+#include "nusystematics/systproviders/GENIEEnginePool.hh"
 #include "nusystematics/systproviders/GENIEResponseParameterAssociation.hh"
 
+#include "nusystematics/utility/ResponseSurrogate.hh"
+
 // GENIE
 #include "RwFramework/GReWeight.h"
 
@@ -11,10 +14,15 @@
 #include "TTree.h"
 
 #include <memory>
+#include <mutex>
 #include <set>
 
 // HERG: HIRD OF RAMPAGING GENIES, HIRD: HERG OF INFINITELY REPEATING DEPTH
 
+/// Each calling thread is given its own GENIE engines, so the response
+/// methods may be called concurrently on one instance, provided that
+/// fill_valid_tree and response profiling are not enabled. With
+/// SurrogateParameters, the responses then depend on thread scheduling.
 class GENIEReWeight : public nusyst::IGENIESystProvider_tool {
 public:
   NEW_SYSTTOOLS_EXCEPT(invalid_engine_state);
@@ -29,6 +37,17 @@ public:
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
 
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
+
+  /// Loops over variations outside of events, so that a reduced HERG is
+  /// only reconfigured once per variation per batch.
+  using nusyst::IGENIESystProvider_tool::GetEventResponses;
+  void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &,
+                    nusyst::EventResponseBlock &);
+
   double GetEventWeightResponse(genie::EventRecord const &,
                                 systtools::param_value_list_t const &);
 
@@ -37,17 +56,71 @@ public:
 
   std::string AsString();
 
+  /// Every instance writes the same validation file, and surrogates are
+  /// trained on the events that each instance happens to see.
+  bool SupportsParallelReplicas() const;
+
+  /// The SurrogateParameters.
+  std::vector<systtools::paramId_t> GetEmulatedParameters() const;
+  /// Writes a surrogate_diagnostics tree with one row per surrogate.
+  void WriteDiagnostics(TDirectory *);
+
   ~GENIEReWeight();
 
 private:
-  /// Set when GetEventWeightResponse has been used as it reconfigures weight
-  /// engines such that GetEventResponse will not perform as expected.
-  bool fHaveReconfiguredOneOfTheHERG;
-
   systtools::ParamResponses
   GetEventGENIEParameterResponse(genie::EventRecord const &, size_t idx);
+  /// Writes the responses to the idx-th GENIE response parameter to
+  /// responses, which must have room for every variation.
+  ///
+  /// \note Callers must hold a ScopedGENIEQuiet.
+  void FillEventGENIEParameterResponse(genie::EventRecord const &, size_t idx,
+                                       double *responses,
+                                       nusyst::GENIEEngineSet &);
+
+  /// Throws if the per-variation engines have been invalidated by
+  /// GetEventWeightResponse.
+  void CheckHERGState(nusyst::GENIEEngineSet const &, bool IsReducedHERG);
+  /// Sets the dials of the single engine of a reduced HERG to the var_it-th
+  /// variation and reconfigures it.
+  void ConfigureReducedHERG(nusyst::GENIEResponseParameter const &,
+                            nusyst::HERG_t &, size_t var_it);
+  /// Fills the responses to the idx-th GENIE response parameter, which has a
+  /// surrogate, either by emulating them or by calculating them with GENIE
+  /// and training the surrogate. Returns whether they were emulated.
+  ///
+  /// \note Callers must hold a ScopedGENIEQuiet.
+  bool FillSurrogateParameterResponse(genie::EventRecord const &,
+                                      nusyst::EventKinematics const &,
+                                      size_t idx, double *responses,
+                                      nusyst::GENIEEngineSet &);
+  /// Calculates the response to the var_it-th variation of the idx-th GENIE
+  /// response parameter with GENIE, ignoring any shared engines.
+  double CalcVariationWeight(genie::EventRecord const &, size_t idx,
+                             size_t var_it, nusyst::HERG_t &);
 
   std::vector<nusyst::GENIEResponseParameter> ResponseToGENIEParameters;
+  std::unique_ptr<nusyst::GENIEEnginePool> EnginePool;
+  /// The largest allowed difference between an adaptive response polynomial
+  /// and GENIE at the check variation.
+  double AdaptiveResponseTolerance;
+  /// Indexed like ResponseToGENIEParameters, null for parameters that are
+  /// always calculated with GENIE. Shared between threads under
+  /// SurrogateMutex, but which events are emulated, and so their responses,
+  /// depends on the order in which events reach this instance.
+  std::vector<std::unique_ptr<nusyst::ResponseSurrogate>> Surrogates;
+  std::mutex SurrogateMutex;
+  /// Also written to on destruction, for applications that do not call
+  /// WriteDiagnostics.
+  std::string SurrogateDiagnosticsFile;
+  /// Appends the emulation residuals of each surrogate to the
+  /// surrogate_diagnostics tree in dir.
+  ///
+  /// \note Callers must hold the surrogate diagnostics mutex.
+  void WriteSurrogateDiagnostics(TDirectory *dir);
+  void PrintSurrogateDiagnostics();
+  /// Span names for each GENIE response parameter's CalcWeight calls.
+  std::vector<nusyst::ResponseTracer::name_id_t> CalcWeightTraceNames;
 
   void extend_ResponseToGENIEParameters(
       std::vector<nusyst::GENIEResponseParameter> &&);
@@ -55,6 +128,7 @@ private:
   fhicl::ParameterSet tool_options;
 
   void InitValidTree();
+  void FillValidTree(genie::EventRecord const &);
 
   bool fill_valid_tree;
   TFile *valid_file;
@@ -1,25 +1,144 @@
 #pragma once
 
+#include "nusystematics/interface/EventApplicability.hh"
+
 #include "systematicstools/utility/exceptions.hh"
 
 // GENIE
 #include "RwFramework/GReWeight.h"
+#include "RwFramework/GReWeightI.h"
 
+#include <algorithm>
+#include <functional>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
 namespace nusyst {
 
 typedef size_t parameter_idx_t;
 
+/// A Hird of Rampaging GENIEs: the engines serving one response parameter.
+/// Engines that are never reconfigured may be shared between HERGs.
+typedef std::vector<std::shared_ptr<genie::rew::GReWeight>> HERG_t;
+
+/// Describes how to build and use the GENIE engines for one response
+/// parameter. The engines themselves are built from this description by
+/// BuildHERG, so that any number of independent copies can be made.
 struct GENIEResponseParameter {
   struct DependentParameter {
     genie::rew::GSyst_t gdial;
     parameter_idx_t pidx;
   };
+  /// A weight calculator adopted by every engine.
+  struct Calculator {
+    std::string name;
+    std::function<genie::rew::GReWeightI *()> Instantiate;
+  };
+
   parameter_idx_t pidx;
   std::vector<DependentParameter> dependents;
-  std::vector<std::unique_ptr<genie::rew::GReWeight>> Herg;
+  std::vector<Calculator> Calculators;
+  /// Dials initialised to a fixed value on every engine, after the
+  /// dependents.
+  std::vector<std::pair<genie::rew::GSyst_t, double>> FixedDials;
+  /// The dependent dial values that each engine is built with.
+  std::vector<std::vector<double>> EngineDialValues;
+  /// The events that the engine's calculator can respond to, every other
+  /// event has a response of exactly 1 and need not be passed to GENIE.
+  EventApplicability applicability;
+  /// For a full HERG, the engine serving each variation. Variations with the
+  /// same dial values share an engine. Empty for a reduced HERG, where the
+  /// single engine is reconfigured for each variation.
+  std::vector<size_t> VariationEngine;
+  /// The first variation served by each engine, i.e. the response slot that
+  /// engine's weight is calculated into before being copied to the others.
+  std::vector<size_t> EngineVariation;
+  /// For adaptive sampling, the variations evaluated to build the response
+  /// polynomial and the held-out variation used to check it. FitVariations
+  /// is empty when every variation is always evaluated.
+  std::vector<size_t> FitVariations;
+  size_t CheckVariation = 0;
+  /// Whether each variation is one of the fit or check variations.
+  std::vector<bool> IsSampledVariation;
+
+  bool IsReducedHERG() const { return VariationEngine.empty(); }
+  bool IsAdaptive() const { return FitVariations.size(); }
+  size_t NEngines() const { return EngineDialValues.size(); }
+
+  /// The names of the adopted calculators, engines of the same family
+  /// share GENIE algorithm and configuration state.
+  std::string FamilyName() const {
+    std::string name;
+    for (Calculator const &calc : Calculators) {
+      name += (name.size() ? "+" : "") + calc.name;
+    }
+    return name;
+  }
+
+  /// Identifies the adopted calculators by name and by the type of their
+  /// instantiator, as calculators of one name are instantiated with
+  /// different modes, which GENIE configures separately.
+  std::string CalculatorKey() const {
+    std::string key;
+    for (Calculator const &calc : Calculators) {
+      key += calc.name + ":" + calc.Instantiate.target_type().name() + ";";
+    }
+    return key;
+  }
+
+  /// Identifies the configuration of the eng_it-th engine: engines with the
+  /// same key, even if serving different parameters, are interchangeable.
+  ///
+  /// Dials at 0, the nominal tweak, are omitted as GENIE treats them
+  /// identically to unset dials.
+  std::string EngineKey(size_t eng_it) const {
+    std::stringstream ss("");
+    ss << CalculatorKey();
+    std::vector<std::pair<genie::rew::GSyst_t, double>> dials = FixedDials;
+    for (size_t d_it = 0; d_it < dependents.size(); ++d_it) {
+      dials.emplace_back(dependents[d_it].gdial,
+                         EngineDialValues[eng_it][d_it]);
+    }
+    std::sort(dials.begin(), dials.end());
+    ss.precision(6);
+    for (auto const &dial : dials) {
+      if (dial.second != 0) {
+        ss << int(dial.first) << "=" << std::fixed << dial.second << ";";
+      }
+    }
+    return ss.str();
+  }
+
+  std::unique_ptr<genie::rew::GReWeight> BuildEngine(size_t eng_it) const {
+    std::unique_ptr<genie::rew::GReWeight> grw =
+        std::make_unique<genie::rew::GReWeight>();
+
+    for (Calculator const &calc : Calculators) {
+      grw->AdoptWghtCalc(calc.name, calc.Instantiate());
+    }
+    for (size_t d_it = 0; d_it < dependents.size(); ++d_it) {
+      grw->Systematics().Init(dependents[d_it].gdial,
+                              EngineDialValues[eng_it][d_it]);
+    }
+    for (auto const &fd : FixedDials) {
+      grw->Systematics().Init(fd.first, fd.second);
+    }
+
+    grw->Reconfigure();
+    return grw;
+  }
+
+  HERG_t BuildHERG() const {
+    HERG_t Herg;
+    for (size_t eng_it = 0; eng_it < NEngines(); ++eng_it) {
+      Herg.push_back(BuildEngine(eng_it));
+    }
+    return Herg;
+  }
 };
 
 NEW_SYSTTOOLS_EXCEPT(invalid_GENIE_parameter_index);
@@ -35,4 +154,3 @@ GENIEResponseParameter &GetResponseParameter(T &RespContainer, parameter_idx_t p
 }
 
 } // namespace nusyst
-
@@ -154,27 +154,44 @@ bool MINERvAE2p2h::SetupResponseCalculator(
     InitValidTree();
   }
 
+  // Only CC MEC events get a non-trivial response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kMEC}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+
   return true;
 }
 
 event_unit_response_t
 MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+event_unit_response_t
+MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev,
+                               EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
+
+void MINERvAE2p2h::FillEventResponse(genie::EventRecord const &ev,
+                                     EventKinematics const &kin,
+                                     EventResponseArena &arena) {
 
-  event_unit_response_t resp;
   SystMetaData const &md = GetSystMetaData();
 
-  if (!ev.Summary()->ProcInfo().IsMEC() ||
-      !ev.Summary()->ProcInfo().IsWeakCC()) {
-    return this->GetDefaultEventResponse();
+  if ((kin.mode != simb_mode_copy::kMEC) || !kin.IsCC) {
+    // Never reached via response_helper, which skips this provider for
+    // events outside of its EventApplicability.
+    arena.Add(this->GetDefaultEventResponse());
+    return;
   }
 
-  genie::GHepParticle *ISLep = ev.Probe();
-  TLorentzVector ISLepP4 = *ISLep->P4();
+  size_t NFilled = arena.GetNFilled();
 
   size_t pidx_Response, pidx_A, pidx_B;
   std::vector<double> *A_var, *B_var;
   double ACV, BCV;
-  Enu = ISLepP4.E();
+  Enu = kin.Enu;
 
   for (int const &nu_pdgsign : {+1, -1}) {
 
@@ -186,17 +203,17 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
     ACV           = nu_pdgsign>0 ? A_nu_CV               : A_nubar_CV;
     BCV           = nu_pdgsign>0 ? B_nu_CV               : B_nubar_CV;
 
-    bool nuMatched = (ISLep->Pdg() * nu_pdgsign > 0);
+    bool nuMatched = (kin.nu_pdg * nu_pdgsign > 0);
 
     if (!ignore_parameter_dependence) {
 
-      resp.push_back({md[pidx_Response].systParamId, {}});
+      double *resp = arena.OpenParameter(md[pidx_Response].systParamId);
 
       for (size_t univ = 0; univ < md[pidx_Response].paramVariations.size();
            ++univ) {
 
         if(!nuMatched){
-          resp.back().responses.push_back(1.);
+          resp[univ] = 1.;
           continue;
         }
 
@@ -209,7 +226,7 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
         weight = (weight < LimitWeights.first) ? LimitWeights.first : weight;
         weight = (weight > LimitWeights.second) ? LimitWeights.second : weight;
 
-        resp.back().responses.push_back(weight);
+        resp[univ] = weight;
       }
 
     } else {
@@ -225,17 +242,18 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
           (CVResponse > LimitWeights.second) ? LimitWeights.second : CVResponse;
 
 #ifdef MINERVAE2p2h_DEBUG
-      std::cout << "[CV Response @ " << Enu << ", " << (ISLep->Pdg()) << ", "
+      std::cout << "[CV Response @ " << Enu << ", " << kin.nu_pdg << ", "
                 << ACV << ", " << BCV << "] = " << CVResponse << std::endl;
 #endif
 
       bool UsedADial = false;
       if (pidx_A != kParamUnhandled<size_t>) {
-        resp.push_back({md[pidx_A].systParamId, {}});
-        for (double av : (*A_var)) {
+        double *resp = arena.OpenParameter(md[pidx_A].systParamId);
+        for (size_t v_it = 0; v_it < A_var->size(); ++v_it) {
+          double av = (*A_var)[v_it];
 
           if(!nuMatched){
-            resp.back().responses.push_back(1.);
+            resp[v_it] = 1.;
             continue;
           }
 
@@ -248,16 +266,17 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
           weight = (weight < LimitWeights.first) ? LimitWeights.first : weight;
           weight = (weight > LimitWeights.second) ? LimitWeights.second : weight;
 
-          resp.back().responses.push_back(weight);
+          resp[v_it] = weight;
         }
         UsedADial = true;
       }
       if (pidx_B != kParamUnhandled<size_t>) {
-        resp.push_back({md[pidx_B].systParamId, {}});
-        for (double bv : (*B_var)) {
+        double *resp = arena.OpenParameter(md[pidx_B].systParamId);
+        for (size_t v_it = 0; v_it < B_var->size(); ++v_it) {
+          double bv = (*B_var)[v_it];
 
           if(!nuMatched){
-            resp.back().responses.push_back(1.);
+            resp[v_it] = 1.;
             continue;
           }
 
@@ -274,7 +293,7 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
           if (UsedADial) {
             weight /= CVResponse;
           }
-          resp.back().responses.push_back(weight);
+          resp[v_it] = weight;
         }
       }
     }
@@ -283,7 +302,7 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
 
   if (fill_valid_tree) {
 
-    int Pdgnu = ISLep->Pdg();
+    int Pdgnu = kin.nu_pdg;
 
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
@@ -295,15 +314,107 @@ MINERvAE2p2h::GetEventResponse(genie::EventRecord const &ev) {
 
     weight = 1;
 
-    for (auto const &eur : resp) {
-      weight *= eur.responses[2];
+    for (size_t f_it = NFilled; f_it < arena.GetNFilled(); ++f_it) {
+      weight *= arena.GetResponses(arena.GetFilledSlot(f_it))[2];
     }
 
     valid_tree->Fill();
   }
+}
+void MINERvAE2p2h::GetEventResponses(
+    std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+    EventResponseBlock &block) {
+
+  // The validation tree is filled event by event.
+  if (fill_valid_tree) {
+    IGENIESystProvider_tool::GetEventResponses(gheps, block);
+    return;
+  }
 
-  return resp;
+  SystMetaData const &md = GetSystMetaData();
+  size_t NEvs = gheps.size();
+
+  // Non CC MEC events get the default response, which leaves every handled
+  // parameter at 1, so they are flagged with a zero pdg sign.
+  batch_NuPdgSign.assign(NEvs, 0);
+  batch_Enu.assign(NEvs, 0);
+  for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+    genie::EventRecord const &ev = *gheps[ev_it];
+    if (!ev.Summary()->ProcInfo().IsMEC() ||
+        !ev.Summary()->ProcInfo().IsWeakCC()) {
+      continue;
+    }
+    batch_NuPdgSign[ev_it] = (ev.Probe()->Pdg() > 0) ? 1 : -1;
+    batch_Enu[ev_it] = ev.Probe()->P4()->E();
+  }
+
+  for (systtools::SystParamHeader const &hdr : md) {
+    if (!hdr.isResponselessParam) {
+      block.SetHandled(block.GetParameterIndex(hdr.systParamId));
+    }
+  }
+
+  auto ClampWeight = [&](double weight) {
+    weight = (weight < LimitWeights.first) ? LimitWeights.first : weight;
+    weight = (weight > LimitWeights.second) ? LimitWeights.second : weight;
+    return weight;
+  };
+
+  auto FillVariation = [&](size_t pidx, size_t univ, int nu_pdgsign,
+                           double Aval, double Bval, bool DivideByCV) {
+    size_t bidx = block.GetParameterIndex(md[pidx].systParamId);
+    double *responses = block.GetResponses(bidx, univ);
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      double weight = ClampWeight(Get_MINERvA2p2h2EnergyDependencyScaling(
+          e2i(simb_mode_copy::kMEC), true, batch_Enu[ev_it], Aval, Bval));
+      if (DivideByCV) {
+        weight /= batch_CVResponse[ev_it];
+      }
+      responses[ev_it] = (batch_NuPdgSign[ev_it] == nu_pdgsign) ? weight : 1.;
+    }
+  };
+
+  for (int const &nu_pdgsign : {+1, -1}) {
+
+    size_t pidx_Response = nu_pdgsign>0 ? pidx_E2p2hResponse_nu : pidx_E2p2hResponse_nubar;
+    size_t pidx_A        = nu_pdgsign>0 ? pidx_E2p2hA_nu        : pidx_E2p2hA_nubar;
+    size_t pidx_B        = nu_pdgsign>0 ? pidx_E2p2hB_nu        : pidx_E2p2hB_nubar;
+    std::vector<double> const &A_var = nu_pdgsign>0 ? A_nu_Variations : A_nubar_Variations;
+    std::vector<double> const &B_var = nu_pdgsign>0 ? B_nu_Variations : B_nubar_Variations;
+    double ACV           = nu_pdgsign>0 ? A_nu_CV               : A_nubar_CV;
+    double BCV           = nu_pdgsign>0 ? B_nu_CV               : B_nubar_CV;
+
+    if (!ignore_parameter_dependence) {
+      for (size_t univ = 0; univ < md[pidx_Response].paramVariations.size();
+           ++univ) {
+        FillVariation(pidx_Response, univ, nu_pdgsign, A_var.at(univ),
+                      B_var.at(univ), false);
+      }
+      continue;
+    }
+
+    batch_CVResponse.resize(NEvs);
+    for (size_t ev_it = 0; ev_it < NEvs; ++ev_it) {
+      batch_CVResponse[ev_it] =
+          ClampWeight(Get_MINERvA2p2h2EnergyDependencyScaling(
+              e2i(simb_mode_copy::kMEC), true, batch_Enu[ev_it], ACV, BCV));
+    }
+
+    bool UsedADial = false;
+    if (pidx_A != kParamUnhandled<size_t>) {
+      for (size_t univ = 0; univ < A_var.size(); ++univ) {
+        FillVariation(pidx_A, univ, nu_pdgsign, A_var[univ], BCV, false);
+      }
+      UsedADial = true;
+    }
+    if (pidx_B != kParamUnhandled<size_t>) {
+      for (size_t univ = 0; univ < B_var.size(); ++univ) {
+        FillVariation(pidx_B, univ, nu_pdgsign, ACV, B_var[univ], UsedADial);
+      }
+    }
+  }
 }
+
 std::string MINERvAE2p2h::AsString() { return "MINERvAE2p2h"; }
 
 void MINERvAE2p2h::InitValidTree() {
@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 class MINERvAE2p2h : public nusyst::IGENIESystProvider_tool {
 
@@ -26,9 +27,22 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
+
+  using nusyst::IGENIESystProvider_tool::GetEventResponses;
+  void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &,
+                    nusyst::EventResponseBlock &);
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~MINERvAE2p2h();
 
 private:
@@ -45,6 +59,10 @@ private:
   std::vector<double> A_nu_Variations, B_nu_Variations, A_nubar_Variations,
       B_nubar_Variations;
 
+  // Per-batch scratch space, reused between batches.
+  std::vector<int> batch_NuPdgSign;
+  std::vector<double> batch_Enu, batch_CVResponse;
+
   void InitValidTree();
 
   bool fill_valid_tree;
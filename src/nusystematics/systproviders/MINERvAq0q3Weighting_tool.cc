@@ -125,9 +125,15 @@ bool MINERvAq0q3Weighting::SetupResponseCalculator(
              "bug, please report to the maintiner.";
     }
 
-    RPATemplateReweighter = std::make_unique<MINERvARPAq0q3_ReWeight>(
-        tool_options.get<fhicl::ParameterSet>(
-            "MINERvATune_RPA_input_manifest"));
+    if (std::shared_ptr<TemplateCache const> cache =
+            TemplateCache::GetActive()) {
+      RPATemplateReweighter = std::make_unique<MINERvARPAq0q3_ReWeight>(
+          cache, GetTemplateCacheKey("RPA"));
+    } else {
+      RPATemplateReweighter = std::make_unique<MINERvARPAq0q3_ReWeight>(
+          tool_options.get<fhicl::ParameterSet>(
+              "MINERvATune_RPA_input_manifest"));
+    }
   }
 
   if (HasParam(GetSystMetaData(), "Mnv2p2hGaussEnhancement")) {
@@ -205,9 +211,21 @@ bool MINERvAq0q3Weighting::SetupResponseCalculator(
       "Mnv2p2hGaussEnhancement_LimitWeights",
       {0, std::numeric_limits<double>::max()});
 
+  // Only CC QE and CC MEC events get a non-trivial response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kQE, simb_mode_copy::kMEC}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+
   return true;
 }
 
+void MINERvAq0q3Weighting::WriteTemplateCache(TemplateCacheWriter &writer) {
+  if (RPATemplateReweighter) {
+    RPATemplateReweighter->WriteTemplateCache(writer,
+                                              GetTemplateCacheKey("RPA"));
+  }
+}
+
 double MINERvAq0q3Weighting::GetMINERvARPATuneWeight(double val, double q0,
                                                      double q3) {
   MINERvARPAq0q3_ReWeight::RPATweak_t tval;
@@ -271,33 +289,39 @@ double MINERvAq0q3Weighting::GetMINERvA2p2hTuneEnhancement(
 
 event_unit_response_t
 MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
 
-  // make default response for configured parameter
-  event_unit_response_t resp;
+event_unit_response_t
+MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev,
+                                       EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
 
-  if (!ev.Summary()->ProcInfo().IsWeakCC()) {
-    return this->GetDefaultEventResponse();
-  }
+void MINERvAq0q3Weighting::FillEventResponse(genie::EventRecord const &ev,
+                                             EventKinematics const &kin,
+                                             EventResponseArena &arena) {
 
-  if (!(ev.Summary()->ProcInfo().IsQuasiElastic() ||
-        ev.Summary()->ProcInfo().IsMEC()) ||
-      ev.Summary()->ExclTag().IsCharmEvent()) {
-    return this->GetDefaultEventResponse();
+  // make default response for configured parameter
+  if (!kin.IsCC) {
+    arena.Add(this->GetDefaultEventResponse());
+    return;
   }
 
-  genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-  genie::GHepParticle *ISLep = ev.Probe();
+  if (!((kin.mode == simb_mode_copy::kQE) ||
+        (kin.mode == simb_mode_copy::kMEC)) ||
+      kin.IsCharm) {
+    arena.Add(this->GetDefaultEventResponse());
+    return;
+  }
 
-  if (!FSLep || !ISLep) {
+  if (!kin.HasLeptons) {
     throw incorrectly_generated()
         << "[ERROR]: Failed to find IS and FS lepton in event: "
         << ev.Summary()->AsString();
   }
 
-  TLorentzVector FSLepP4 = *FSLep->P4();
-  TLorentzVector ISLepP4 = *ISLep->P4();
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-  std::array<double, 2> q0q3{{emTransfer.E(), emTransfer.Vect().Mag()}};
+  std::array<double, 2> q0q3{{kin.q0, kin.q3}};
 
   if (ConfiguredParameters.find(param_t::kMINERvARPA) !=
       ConfiguredParameters.end()) {
@@ -305,19 +329,19 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvARPA]];
 
-    resp.push_back({hdr.systParamId, {}});
+    double *resp = arena.OpenParameter(hdr.systParamId);
     if (hdr.isCorrection) {
-      resp.back().responses.push_back(
-          GetMINERvARPATuneWeight(hdr.centralParamValue, q0q3[0], q0q3[1]));
+      resp[0] =
+          GetMINERvARPATuneWeight(hdr.centralParamValue, q0q3[0], q0q3[1]);
     } else {
-      for (double var : hdr.paramVariations) {
-        resp.back().responses.push_back(
-            GetMINERvARPATuneWeight(var, q0q3[0], q0q3[1]));
+      for (size_t v_it = 0; v_it < hdr.paramVariations.size(); ++v_it) {
+        resp[v_it] = GetMINERvARPATuneWeight(hdr.paramVariations[v_it],
+                                             q0q3[0], q0q3[1]);
       }
     }
   }
 
-  QELikeTarget_t qel_targ = GetQELikeTarget(ev);
+  QELikeTarget_t qel_targ = GetQELikeTarget(ev, kin);
 
   // Only ever applies to 2p2h/qe events
   if ((ConfiguredParameters.find(param_t::kMINERvA2p2h) !=
@@ -327,13 +351,14 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvA2p2h]];
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double var : vals_2p2hTotal) {
+    double *resp = arena.OpenParameter(hdr.systParamId);
+    for (size_t v_it = 0; v_it < vals_2p2hTotal.size(); ++v_it) {
+      double var = vals_2p2hTotal[v_it];
       double wght =
           GetMINERvA2p2hTuneEnhancement(var, q0q3[0], q0q3[1], qel_targ);
       wght = (wght < MEC_LimitWeights.first) ? MEC_LimitWeights.first : wght;
       wght = (wght > MEC_LimitWeights.second) ? MEC_LimitWeights.second : wght;
-      resp.back().responses.push_back(wght);
+      resp[v_it] = wght;
     }
   }
 
@@ -345,8 +370,9 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvA2p2h_CV]];
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double v : vals_2p2hCV) {
+    double *resp = arena.OpenParameter(hdr.systParamId);
+    for (size_t v_it = 0; v_it < vals_2p2hCV.size(); ++v_it) {
+      double v = vals_2p2hCV[v_it];
       double cv_weight =
           1 + v * GetMINERvA2p2hTuneEnhancement(1, q0q3[0], q0q3[1], qel_targ);
 
@@ -356,7 +382,7 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
                       ? MEC_LimitWeights.second
                       : cv_weight;
 
-      resp.back().responses.push_back(cv_weight);
+      resp[v_it] = cv_weight;
     }
   }
   // Only ever applies to 2p2h events
@@ -367,8 +393,9 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvA2p2h_NN]];
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double v : vals_2p2hNN) {
+    double *resp = arena.OpenParameter(hdr.systParamId);
+    for (size_t v_it = 0; v_it < vals_2p2hNN.size(); ++v_it) {
+      double v = vals_2p2hNN[v_it];
       double tune_ench =
           v * GetMINERvA2p2hTuneEnhancement(2, q0q3[0], q0q3[1], qel_targ);
 
@@ -378,7 +405,7 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
                       ? MEC_LimitWeights.second
                       : tune_ench;
 
-      resp.back().responses.push_back(tune_ench);
+      resp[v_it] = tune_ench;
     }
   }
   // Only ever applies to 2p2h events
@@ -389,8 +416,9 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvA2p2h_np]];
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double v : vals_2p2hnp) {
+    double *resp = arena.OpenParameter(hdr.systParamId);
+    for (size_t v_it = 0; v_it < vals_2p2hnp.size(); ++v_it) {
+      double v = vals_2p2hnp[v_it];
       double tune_ench =
           v * GetMINERvA2p2hTuneEnhancement(3, q0q3[0], q0q3[1], qel_targ);
 
@@ -400,7 +428,7 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
                       ? MEC_LimitWeights.second
                       : tune_ench;
 
-      resp.back().responses.push_back(tune_ench);
+      resp[v_it] = tune_ench;
     }
   }
   // Only ever applies to qe events
@@ -411,8 +439,9 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     SystParamHeader const &hdr =
         GetSystMetaData()[ConfiguredParameters[param_t::kMINERvA2p2h_QE]];
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double v : vals_2p2hQE) {
+    double *resp = arena.OpenParameter(hdr.systParamId);
+    for (size_t v_it = 0; v_it < vals_2p2hQE.size(); ++v_it) {
+      double v = vals_2p2hQE[v_it];
       double tune_ench =
           v * GetMINERvA2p2hTuneEnhancement(4, q0q3[0], q0q3[1], qel_targ);
 
@@ -422,17 +451,20 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
                       ? MEC_LimitWeights.second
                       : tune_ench;
 
-      resp.back().responses.push_back(tune_ench);
+      resp[v_it] = tune_ench;
     }
   }
 
   if (fill_valid_tree) {
 
-    pdgfslep = ev.FinalStatePrimaryLepton()->Pdg();
-    momfslep = FSLepP4.Vect().Mag();
-    cthetafslep = FSLepP4.Vect().CosTheta();
+    // Only used for validation, so allowed to allocate.
+    event_unit_response_t resp = arena.GetEventResponse();
+
+    pdgfslep = kin.FSLep->Pdg();
+    momfslep = kin.FSLepP4.Vect().Mag();
+    cthetafslep = kin.FSLepP4.Vect().CosTheta();
 
-    Pdgnu = ISLep->Pdg();
+    Pdgnu = kin.nu_pdg;
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
         ev.Summary()->ProcInfo().IsWeakCC()) {
@@ -443,11 +475,11 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
 
     QELTarget = e2i(qel_targ);
 
-    Enu = ISLepP4.E();
-    Q2 = -emTransfer.Mag2();
-    W = ev.Summary()->Kine().W(true);
-    q0 = emTransfer.E();
-    q3 = emTransfer.Vect().Mag();
+    Enu = kin.Enu;
+    Q2 = kin.Q2;
+    W = GetW(ev, kin);
+    q0 = kin.q0;
+    q3 = kin.q3;
 
     RPA_weights.clear();
     MEC_weights.clear();
@@ -489,8 +521,6 @@ MINERvAq0q3Weighting::GetEventResponse(genie::EventRecord const &ev) {
     nMEC_weights = MEC_weights.size();
     valid_tree->Fill();
   }
-
-  return resp;
 }
 
 std::string MINERvAq0q3Weighting::AsString() { return ""; }
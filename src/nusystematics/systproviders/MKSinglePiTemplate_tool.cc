@@ -145,9 +145,17 @@ bool MKSinglePiTemplate::SetupResponseCalculator(
     }
 
     TemplateHelper th;
-    th.Template = std::make_unique<MKSinglePiTemplate_ReWeight>(
-        templateManifest.get<fhicl::ParameterSet>(ch.name));
-    th.ZeroIsValid = th.Template->IsValidVariation(0);
+    th.CacheKey = GetTemplateCacheKey(ch.name);
+    if (std::shared_ptr<TemplateCache const> cache =
+            TemplateCache::GetActive()) {
+      th.Template =
+          std::make_unique<MKSinglePiTemplate_ReWeight>(cache, th.CacheKey);
+    } else {
+      th.Template = std::make_unique<MKSinglePiTemplate_ReWeight>(
+          templateManifest.get<fhicl::ParameterSet>(ch.name));
+    }
+    th.Template->ResolveVariations(
+        GetSystMetaData()[ResponseParameterIdx].paramVariations);
 
     ChannelParameterMapping.emplace(ch.channel, std::move(th));
   }
@@ -264,16 +272,18 @@ MKSinglePiTemplate::GetEventResponse(genie::EventRecord const &ev) {
       std::swap(kinematics[0], kinematics[1]);
     }
 
-    resp.push_back({hdr.systParamId, {}});
-    for (double val : hdr.paramVariations) {
+    MKSinglePiTemplate_ReWeight const &tmpl =
+        *ChannelParameterMapping[chan].Template;
+    MKSinglePiTemplate_ReWeight::flat_bin_it_t bin =
+        tmpl.GetFlatBin(ISLepP4.E(), kinematics);
 
-      if ((val == 0) && !ChannelParameterMapping[chan].ZeroIsValid) {
-        resp.back().responses.push_back(1);
-      } else {
-        resp.back().responses.push_back(
-            ChannelParameterMapping[chan].Template->GetVariation(
-                val, ISLepP4.E(), kinematics));
-      }
+    resp.push_back({hdr.systParamId, {}});
+    if (bin == MKSinglePiTemplate_ReWeight::kFlatBinOutsideRange) {
+      resp.back().responses.assign(hdr.paramVariations.size(), 1);
+    } else {
+      double const *bin_resp = tmpl.GetResolvedResponses(bin);
+      resp.back().responses.assign(bin_resp,
+                                   bin_resp + hdr.paramVariations.size());
     }
   } else { // Non-resonant background has to die off as MK is turned on, as the
            // MK prediction includes the coupled background channels
@@ -346,6 +356,13 @@ MKSinglePiTemplate::GetEventResponse(genie::EventRecord const &ev) {
   return resp;
 }
 
+void MKSinglePiTemplate::WriteTemplateCache(TemplateCacheWriter &writer) {
+  for (auto const &chan_th : ChannelParameterMapping) {
+    TemplateHelper const &th = chan_th.second;
+    th.Template->WriteTemplateCache(writer, th.CacheKey);
+  }
+}
+
 std::string MKSinglePiTemplate::AsString() { return ""; }
 
 void MKSinglePiTemplate::InitValidTree() {
@@ -19,7 +19,7 @@ class MKSinglePiTemplate : public nusyst::IGENIESystProvider_tool {
 
   struct TemplateHelper {
     std::unique_ptr<nusyst::MKSinglePiTemplate_ReWeight> Template;
-    bool ZeroIsValid;
+    std::string CacheKey;
   };
 
   std::map<genie::SppChannel_t, TemplateHelper> ChannelParameterMapping;
@@ -35,8 +35,13 @@ public:
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
 
+  void WriteTemplateCache(nusyst::TemplateCacheWriter &);
+
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~MKSinglePiTemplate();
 
 private:
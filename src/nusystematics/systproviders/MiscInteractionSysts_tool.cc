@@ -9,6 +9,8 @@
 #include "nusystematics/responsecalculators/nuenuebar_xsec_ratio.hh"
 #include "nusystematics/responsecalculators/nuenumu_xsec_ratio.hh"
 
+#include <algorithm>
+
 using namespace nusyst;
 
 MiscInteractionSysts::MiscInteractionSysts(fhicl::ParameterSet const &params)
@@ -73,170 +75,144 @@ bool MiscInteractionSysts::SetupResponseCalculator(
   return true;
 }
 
-std::vector<double> MiscInteractionSysts::GetWeights_C12ToAr40_2p2hScaling(
-    genie::EventRecord const &ev, std::vector<double> const &vals) {
-
-  std::vector<double> resp;
+void MiscInteractionSysts::FillWeights_C12ToAr40_2p2hScaling(
+    genie::EventRecord const &ev, EventKinematics const &kin,
+    std::vector<double> const &vals, double *resp) {
 
-  QELikeTarget_t mec_topology = GetQELikeTarget(ev);
+  QELikeTarget_t mec_topology = GetQELikeTarget(ev, kin);
 
   if ((mec_topology == nusyst::QELikeTarget_t::kQE) ||
       (mec_topology == nusyst::QELikeTarget_t::kInvalidTopology)) {
-    return std::vector<double>(vals.size(), 1.);
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  for (double v : vals) {
-    resp.push_back(GetC_Ar2p2hScalingWeight(v));
+  for (size_t v_it = 0; v_it < vals.size(); ++v_it) {
+    resp[v_it] = GetC_Ar2p2hScalingWeight(vals[v_it]);
   }
-
-  return resp;
 }
 
-std::vector<double> MiscInteractionSysts::GetWeights_nuenuebar_xsec_ratio(
-    genie::EventRecord const &ev, std::vector<double> const &vals) {
-
-  std::vector<double> resp;
+void MiscInteractionSysts::FillWeights_nuenuebar_xsec_ratio(
+    genie::EventRecord const &ev, EventKinematics const &kin,
+    std::vector<double> const &vals, double *resp) {
 
-  genie::GHepParticle *ISLep = ev.Probe();
-  if (abs(ISLep->Pdg()) != 12) {
-    return std::vector<double>(vals.size(), 1.);
+  if (abs(kin.nu_pdg) != 12) {
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  if (!ev.Summary()->ProcInfo().IsWeakCC()) {
-    return std::vector<double>(vals.size(), 1.);
+  if (!kin.IsCC) {
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  int pdgnu = ISLep->Pdg();
-  double enu = ISLep->P4()->E();
+  int pdgnu = kin.nu_pdg;
+  double enu = kin.Enu;
 
-  for (double v : vals) {
-    resp.push_back(GetNueNueBarXSecRatioWeight(pdgnu, true, enu, v));
+  for (size_t v_it = 0; v_it < vals.size(); ++v_it) {
+    resp[v_it] = GetNueNueBarXSecRatioWeight(pdgnu, true, enu, vals[v_it]);
   }
-
-  return resp;
 }
-std::vector<double> MiscInteractionSysts::GetWeights_nuenumu_xsec_ratio(
-    genie::EventRecord const &ev, std::vector<double> const &vals) {
-
-  std::vector<double> resp;
+void MiscInteractionSysts::FillWeights_nuenumu_xsec_ratio(
+    genie::EventRecord const &ev, EventKinematics const &kin,
+    std::vector<double> const &vals, double *resp) {
 
-  genie::GHepParticle *ISLep = ev.Probe();
-  if (abs(ISLep->Pdg()) != 12) {
-    return std::vector<double>(vals.size(), 1.);
+  if (abs(kin.nu_pdg) != 12) {
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  if (!ev.Summary()->ProcInfo().IsWeakCC()) {
-    return std::vector<double>(vals.size(), 1.);
+  if (!kin.IsCC) {
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  int pdgnu = ISLep->Pdg();
-
-  TLorentzVector ISLepP4 = *ISLep->P4();
-
-  double enu = ISLepP4.E();
+  int pdgnu = kin.nu_pdg;
+  double enu = kin.Enu;
+  double q0_GeV = kin.q0;
+  double q3_GeV = kin.q3;
 
-  TLorentzVector FSLepP4 = *ev.FinalStatePrimaryLepton()->P4();
-
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-
-  double q0_GeV = emTransfer.E();
-  double q3_GeV = emTransfer.Vect().Mag();
-
-  for (double v : vals) {
-    resp.push_back(GetNueNumuRatioWeight(pdgnu, true, enu, q0_GeV, q3_GeV, v));
+  for (size_t v_it = 0; v_it < vals.size(); ++v_it) {
+    resp[v_it] = GetNueNumuRatioWeight(pdgnu, true, enu, q0_GeV, q3_GeV,
+                                       vals[v_it]);
   }
-
-  return resp;
 }
-std::vector<double> MiscInteractionSysts::GetWeights_SPPLowQ2Suppression(
-    genie::EventRecord const &ev, std::vector<double> const &vals) {
-
-  std::vector<double> resp;
+void MiscInteractionSysts::FillWeights_SPPLowQ2Suppression(
+    genie::EventRecord const &ev, EventKinematics const &kin,
+    std::vector<double> const &vals, double *resp) {
 
   if (SPPChannelFromGHep(ev) == genie::kSppNull) {
-    return std::vector<double>(vals.size(), 1.);
+    std::fill_n(resp, vals.size(), 1.);
+    return;
   }
 
-  TLorentzVector ISLepP4 = *ev.Probe()->P4();
-
-  TLorentzVector FSLepP4 = *ev.FinalStatePrimaryLepton()->P4();
-
-  TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-  double Q2_GeV = -emTransfer.Mag2();
+  double Q2_GeV = kin.Q2;
 
-  for (double v : vals) {
-    resp.push_back(GetMINERvASPPLowQ2SuppressionWeight(e2i(GetSimbMode(ev)),
-                                                       true, Q2_GeV, v));
+  for (size_t v_it = 0; v_it < vals.size(); ++v_it) {
+    resp[v_it] = GetMINERvASPPLowQ2SuppressionWeight(e2i(kin.mode), true,
+                                                     Q2_GeV, vals[v_it]);
   }
-
-  return resp;
 }
 
 systtools::event_unit_response_t
 MiscInteractionSysts::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponse(ev, BuildEventKinematics(ev));
+}
+
+systtools::event_unit_response_t
+MiscInteractionSysts::GetEventResponse(genie::EventRecord const &ev,
+                                       EventKinematics const &kin) {
+  return GetEventResponseFromArena(ev, kin);
+}
 
-  systtools::event_unit_response_t resp;
+void MiscInteractionSysts::FillEventResponse(genie::EventRecord const &ev,
+                                             EventKinematics const &kin,
+                                             EventResponseArena &arena) {
 
   systtools::SystMetaData const &md = GetSystMetaData();
 
-  if (pidx_C12ToAr40_2p2hScaling_nu != systtools::kParamUnhandled<size_t>) {
-    std::vector<double> wght = (ev.Probe()->Pdg() > 0) ? GetWeights_C12ToAr40_2p2hScaling(ev, md[pidx_C12ToAr40_2p2hScaling_nu].paramVariations)
-                                                       : std::vector<double>(md[pidx_C12ToAr40_2p2hScaling_nu].paramVariations.size(), 1.);
-    if (wght.size()) {
-      resp.push_back(
-          {md[pidx_C12ToAr40_2p2hScaling_nu].systParamId, std::move(wght)});
+  // Parameters without any variations never get a response.
+  auto OpenIfHandled = [&](size_t pidx) -> double * {
+    if ((pidx == systtools::kParamUnhandled<size_t>) ||
+        !md[pidx].paramVariations.size()) {
+      return nullptr;
     }
-  }
-  if (pidx_C12ToAr40_2p2hScaling_nubar != systtools::kParamUnhandled<size_t>) {
-    std::vector<double> wght = (ev.Probe()->Pdg() < 0) ? GetWeights_C12ToAr40_2p2hScaling(ev, md[pidx_C12ToAr40_2p2hScaling_nubar].paramVariations)
-                                                       : std::vector<double>(md[pidx_C12ToAr40_2p2hScaling_nubar].paramVariations.size(), 1.);
-    if (wght.size()) {
-      resp.push_back(
-          {md[pidx_C12ToAr40_2p2hScaling_nubar].systParamId, std::move(wght)});
+    return arena.OpenParameter(md[pidx].systParamId);
+  };
+
+  if (double *resp = OpenIfHandled(pidx_C12ToAr40_2p2hScaling_nu)) {
+    std::vector<double> const &vals =
+        md[pidx_C12ToAr40_2p2hScaling_nu].paramVariations;
+    if (kin.nu_pdg > 0) {
+      FillWeights_C12ToAr40_2p2hScaling(ev, kin, vals, resp);
+    } else {
+      std::fill_n(resp, vals.size(), 1.);
     }
   }
-  if (pidx_nuenuebar_xsec_ratio != systtools::kParamUnhandled<size_t>) {
-    std::vector<double> wght = GetWeights_nuenuebar_xsec_ratio(
-        ev, md[pidx_nuenuebar_xsec_ratio].paramVariations);
-    if (wght.size()) {
-      resp.push_back(
-          {md[pidx_nuenuebar_xsec_ratio].systParamId, std::move(wght)});
+  if (double *resp = OpenIfHandled(pidx_C12ToAr40_2p2hScaling_nubar)) {
+    std::vector<double> const &vals =
+        md[pidx_C12ToAr40_2p2hScaling_nubar].paramVariations;
+    if (kin.nu_pdg < 0) {
+      FillWeights_C12ToAr40_2p2hScaling(ev, kin, vals, resp);
+    } else {
+      std::fill_n(resp, vals.size(), 1.);
     }
   }
-  if (pidx_nuenumu_xsec_ratio != systtools::kParamUnhandled<size_t>) {
-    std::vector<double> wght = GetWeights_nuenumu_xsec_ratio(
-        ev, md[pidx_nuenumu_xsec_ratio].paramVariations);
-    if (wght.size()) {
-      resp.push_back(
-          {md[pidx_nuenumu_xsec_ratio].systParamId, std::move(wght)});
-    }
+  if (double *resp = OpenIfHandled(pidx_nuenuebar_xsec_ratio)) {
+    FillWeights_nuenuebar_xsec_ratio(
+        ev, kin, md[pidx_nuenuebar_xsec_ratio].paramVariations, resp);
   }
-  if (pidx_SPPLowQ2Suppression != systtools::kParamUnhandled<size_t>) {
-    std::vector<double> wght = GetWeights_SPPLowQ2Suppression(
-        ev, md[pidx_SPPLowQ2Suppression].paramVariations);
-    if (wght.size()) {
-      resp.push_back(
-          {md[pidx_SPPLowQ2Suppression].systParamId, std::move(wght)});
-    }
+  if (double *resp = OpenIfHandled(pidx_nuenumu_xsec_ratio)) {
+    FillWeights_nuenumu_xsec_ratio(
+        ev, kin, md[pidx_nuenumu_xsec_ratio].paramVariations, resp);
   }
-
-  // Remove any empty responses
-  for (size_t r_it = 0; r_it < resp.size();) {
-    if (!resp[r_it].responses.size()) {
-      resp.erase(resp.begin() + r_it);
-    } else {
-      ++r_it;
-    }
+  if (double *resp = OpenIfHandled(pidx_SPPLowQ2Suppression)) {
+    FillWeights_SPPLowQ2Suppression(
+        ev, kin, md[pidx_SPPLowQ2Suppression].paramVariations, resp);
   }
 
   if (fill_valid_tree) {
-    genie::GHepParticle *FSLep = ev.FinalStatePrimaryLepton();
-    genie::GHepParticle *ISLep = ev.Probe();
-    TLorentzVector FSLepP4 = *FSLep->P4();
-    TLorentzVector ISLepP4 = *ISLep->P4();
-    TLorentzVector emTransfer = (ISLepP4 - FSLepP4);
-
-    int Pdgnu = ISLep->Pdg();
+    int Pdgnu = kin.nu_pdg;
 
     NEUTMode = 0;
     if (ev.Summary()->ProcInfo().IsMEC() &&
@@ -246,15 +222,13 @@ MiscInteractionSysts::GetEventResponse(genie::EventRecord const &ev) {
       NEUTMode = genie::utils::ghep::NeutReactionCode(&ev);
     }
 
-    Enu = ISLepP4.E();
-    Q2 = -emTransfer.Mag2();
+    Enu = kin.Enu;
+    Q2 = kin.Q2;
 
-    W = ev.Summary()->Kine().W(true);
+    W = GetW(ev, kin);
 
     valid_tree->Fill();
   }
-
-  return resp;
 }
 std::string MiscInteractionSysts::AsString() { return "MiscInteractionSysts"; }
 
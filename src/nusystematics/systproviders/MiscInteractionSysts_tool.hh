@@ -20,9 +20,17 @@ public:
                                             systtools::paramId_t);
 
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  systtools::event_unit_response_t
+  GetEventResponse(genie::EventRecord const &, nusyst::EventKinematics const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~MiscInteractionSysts();
 
 private:
@@ -34,18 +42,18 @@ private:
   size_t pidx_nuenumu_xsec_ratio;
   size_t pidx_SPPLowQ2Suppression;
 
-  std::vector<double>
-  GetWeights_C12ToAr40_2p2hScaling(genie::EventRecord const &,
-                                   std::vector<double> const &);
-  std::vector<double>
-  GetWeights_nuenuebar_xsec_ratio(genie::EventRecord const &,
-                                  std::vector<double> const &);
-  std::vector<double>
-  GetWeights_nuenumu_xsec_ratio(genie::EventRecord const &,
-                                std::vector<double> const &);
-  std::vector<double>
-  GetWeights_SPPLowQ2Suppression(genie::EventRecord const &,
-                                 std::vector<double> const &);
+  void FillWeights_C12ToAr40_2p2hScaling(genie::EventRecord const &,
+                                         nusyst::EventKinematics const &,
+                                         std::vector<double> const &, double *);
+  void FillWeights_nuenuebar_xsec_ratio(genie::EventRecord const &,
+                                        nusyst::EventKinematics const &,
+                                        std::vector<double> const &, double *);
+  void FillWeights_nuenumu_xsec_ratio(genie::EventRecord const &,
+                                      nusyst::EventKinematics const &,
+                                      std::vector<double> const &, double *);
+  void FillWeights_SPPLowQ2Suppression(genie::EventRecord const &,
+                                       nusyst::EventKinematics const &,
+                                       std::vector<double> const &, double *);
 
   void InitValidTree();
 
@@ -31,6 +31,9 @@ public:
 
   std::string AsString();
 
+  /// Every instance writes the same validation file.
+  bool SupportsParallelReplicas() const { return !fill_valid_tree; }
+
   ~NOvAStyleNonResPionNorm();
 
 private:
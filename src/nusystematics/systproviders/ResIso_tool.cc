@@ -114,20 +114,29 @@ bool ResIso::SetupResponseCalculator(
       }
     }
   }
+  // Only CC RES events get a response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kRes}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kEmpty);
+
   // returning cleanly
   return true;
 }
 
 event_unit_response_t
 ResIso::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponseFromArena(ev, BuildEventKinematics(ev));
+}
+
+void ResIso::FillEventResponse(genie::EventRecord const &ev,
+                               EventKinematics const &kin,
+                               EventResponseArena &arena) {
 
-  event_unit_response_t resp;
   SystMetaData const &md = GetSystMetaData();
 
   // return early if this event isn't one we provide responses for
-  if (!ev.Summary()->ProcInfo().IsResonant() ||
-      !ev.Summary()->ProcInfo().IsWeakCC()) {
-    return resp;
+  if ((kin.mode != simb_mode_copy::kRes) || !kin.IsCC) {
+    return;
   }
 
   // loop through and calculate weights
@@ -143,22 +152,19 @@ ResIso::GetEventResponse(genie::EventRecord const &ev) {
 
     auto param_id = md[pidx_Params[i]].systParamId;
     // initialize the response array with this paramId
-    resp.push_back({param_id, {}});
+    double *resp = arena.OpenParameter(param_id);
 
     // loop through variations for this parameter
     for (size_t v_it = 0; v_it < Variations[i].size(); ++v_it) {
 
       // put the response weight for this variation of this parameter into the
       // response object
-      resp.back().responses.push_back(ReWeightEngines[i][v_it].CalcWeight(ev));
+      resp[v_it] = ReWeightEngines[i][v_it].CalcWeight(ev);
       if (verbosity_level > 3) {
         std::cout << "[DEBG]: For parameter " << md[pidx_Params[i]].prettyName
                   << " at variation[" << v_it << "] = " << Variations[i][v_it]
-                  << " calculated weight: " << resp.back().responses.back()
-                  << std::endl;
+                  << " calculated weight: " << resp[v_it] << std::endl;
       }
     }
   }
-
-  return resp;
 }
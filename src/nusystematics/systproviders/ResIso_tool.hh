@@ -35,6 +35,9 @@ public:
 
   // Parameter-specific implementation goes in here
   systtools::event_unit_response_t GetEventResponse(genie::EventRecord const &);
+  void FillEventResponse(genie::EventRecord const &,
+                         nusyst::EventKinematics const &,
+                         nusyst::EventResponseArena &);
 
   // Can add as much or as little stateful information here for use when
   // representing this instance as a string.
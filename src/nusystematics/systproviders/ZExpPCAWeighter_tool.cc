@@ -220,20 +220,29 @@ bool ZExpPCAWeighter::SetupResponseCalculator(
       }
     }
   }
+  // Only CC QE events get a non-trivial response.
+  applicability = EventApplicability(
+      {simb_mode_copy::kQE}, {EventApplicability::kCC},
+      EventApplicability::outside_response_t::kDefault);
+
   return true; // returning cleanly
 }
 
 event_unit_response_t
 ZExpPCAWeighter::GetEventResponse(genie::EventRecord const &ev) {
+  return GetEventResponseFromArena(ev, BuildEventKinematics(ev));
+}
+
+void ZExpPCAWeighter::FillEventResponse(genie::EventRecord const &ev,
+                                        EventKinematics const &kin,
+                                        EventResponseArena &arena) {
 
-  event_unit_response_t resp;
   SystMetaData const &md = GetSystMetaData();
 
   // return early if this event isn't one we provide responses for
-  if (!ev.Summary()->ProcInfo().IsQuasiElastic() ||
-      !ev.Summary()->ProcInfo().IsWeakCC() ||
-      ev.Summary()->ExclTag().IsCharmEvent()) {
-    return this->GetDefaultEventResponse();
+  if ((kin.mode != simb_mode_copy::kQE) || !kin.IsCC || kin.IsCharm) {
+    arena.Add(this->GetDefaultEventResponse());
+    return;
   }
 
   // loop through and calculate weights
@@ -244,25 +253,22 @@ ZExpPCAWeighter::GetEventResponse(genie::EventRecord const &ev) {
     }
 
     // initialize the response array with this paramId
-    resp.push_back({md[pidx_Params[b_i]].systParamId, {}});
+    double *resp = arena.OpenParameter(md[pidx_Params[b_i]].systParamId);
 
     // loop through variations for this parameter
     for (size_t v_it = 0; v_it < Variations[b_i].size(); ++v_it) {
 
       // put the response weight for this variation of this parameter into the
       // response object
-      resp.back().responses.push_back(
-          ReWeightEngines_new[b_i][v_it]->CalcWeight(ev));
+      resp[v_it] = ReWeightEngines_new[b_i][v_it]->CalcWeight(ev);
 
       if (verbosity_level > 3) {
         std::cout << "[DEBG]: For parameter " << md[pidx_Params[b_i]].prettyName
                   << "The  central value of the parameter is  " << CVs[b_i]
                   << " at variation[" << v_it
                   << "] std = " << Variations[b_i][v_it]
-                  << " calculated weight: " << resp.back().responses.back()
-                  << std::endl;
+                  << " calculated weight: " << resp[v_it] << std::endl;
       }
     }
   }
-  return resp;
 }
@@ -0,0 +1,112 @@
+#include "nusystematics/systproviders/GENIEAdaptiveSampling.hh"
+
+#include "systematicstools/interface/SystMetaData.hh"
+
+// GENIE
+#include "RwFramework/GSyst.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace nusyst;
+
+systtools::SystParamHeader MakeHeader(std::string const &name,
+                                      std::vector<double> const &vars) {
+  systtools::SystParamHeader hdr;
+  hdr.prettyName = name;
+  hdr.centralParamValue = 0;
+  hdr.paramVariations = vars;
+  return hdr;
+}
+
+bool Expect(bool pass, std::string const &what) {
+  if (!pass) {
+    std::cout << "[ERROR]: Expected " << what << std::endl;
+  }
+  return pass;
+}
+
+int main() {
+  size_t const Order = 2;
+  double const Tolerance = 1E-3;
+
+  systtools::SystMetaData md;
+  md.push_back(MakeHeader("MaCCQE", {-3, -2, -1, 0, 1, 2, 3}));
+  // Universe indices, each throwing both z-expansion dials.
+  md.push_back(MakeHeader("ZExpAVariationResponse", {0, 1, 2, 3, 4, 5, 6}));
+  md.push_back(
+      MakeHeader("ZExpA1CCQE", {0.3, -1.2, 2.1, -0.4, 1.7, -2.5, 0.9}));
+  md.push_back(
+      MakeHeader("ZExpA2CCQE", {-0.8, 1.4, 0.2, -2.2, 0.6, 1.1, -1.5}));
+  for (size_t p_it = 0; p_it < md.size(); ++p_it) {
+    md[p_it].systParamId = p_it;
+  }
+
+  bool pass = true;
+
+  GENIEResponseParameter MaCCQE;
+  MaCCQE.pidx = 0;
+  MaCCQE.dependents.push_back({genie::rew::kXSecTwkDial_MaCCQE, 0});
+  PlanAdaptiveSampling(MaCCQE, md, Order);
+  pass = Expect(MaCCQE.IsAdaptive(), "a single-dial response to be sampled") &&
+         pass;
+  if (MaCCQE.IsAdaptive()) {
+    std::vector<double> resp;
+    for (double v : md[0].paramVariations) {
+      resp.push_back(MaCCQE.IsSampledVariation[resp.size()]
+                         ? (1 + 0.1 * v + 0.02 * v * v)
+                         : 0);
+    }
+    bool filled = FillFromResponsePolynomial(
+        MaCCQE, md[0], Tolerance,
+        [&](size_t var_it) -> double & { return resp[var_it]; });
+    pass = Expect(filled, "a quadratic response to pass the check") && pass;
+    for (size_t var_it = 0; var_it < resp.size(); ++var_it) {
+      double v = md[0].paramVariations[var_it];
+      pass = Expect(std::fabs(resp[var_it] - (1 + 0.1 * v + 0.02 * v * v)) <
+                        1E-8,
+                    "a quadratic response to be interpolated exactly") &&
+             pass;
+    }
+  }
+
+  // Not smooth in the universe index, but constant at the variations that
+  // would be fit and checked, so the check alone would not reject it.
+  std::vector<double> const ZExpResp = {1, 1, 1.5, 1, 0.7, 1.2, 1};
+
+  GENIEResponseParameter ZExp;
+  ZExp.pidx = 1;
+  ZExp.dependents.push_back({genie::rew::kXSecTwkDial_ZExpA1CCQE, 2});
+  ZExp.dependents.push_back({genie::rew::kXSecTwkDial_ZExpA2CCQE, 3});
+
+  GENIEResponseParameter Unguarded = ZExp;
+  Unguarded.FitVariations = {0, 3, 6};
+  Unguarded.CheckVariation = 1;
+  Unguarded.IsSampledVariation = {true, true, false, true, false, false, true};
+  std::vector<double> resp = ZExpResp;
+  pass = Expect(FillFromResponsePolynomial(
+                    Unguarded, md[1], Tolerance,
+                    [&](size_t var_it) -> double & { return resp[var_it]; }),
+                "the fit check to miss a non-smooth multi-dial response") &&
+         pass;
+
+  PlanAdaptiveSampling(ZExp, md, Order);
+  pass = Expect(!ZExp.IsAdaptive(),
+                "a multi-dial response not to be interpolated") &&
+         pass;
+
+  // A response parameter with a single dependent that is still indexed by
+  // universe.
+  GENIEResponseParameter ZExpA1Only;
+  ZExpA1Only.pidx = 1;
+  ZExpA1Only.dependents.push_back({genie::rew::kXSecTwkDial_ZExpA1CCQE, 2});
+  PlanAdaptiveSampling(ZExpA1Only, md, Order);
+  pass = Expect(!ZExpA1Only.IsAdaptive(),
+                "a response with a differently valued dial not to be "
+                "interpolated") &&
+         pass;
+
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+#include "nusystematics/utility/make_instance.hh"
+#include "nusystematics/utility/parallel_response_helper.hh"
+
+#include "systematicstools/utility/ParameterAndProviderConfigurationUtility.hh"
+
+#include "fhiclcpp/ParameterSet.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Writes the generated parameter headers for a MiscInteractionSysts instance,
+// as GenerateSystProviderConfigNuSyst would.
+void WriteConfig(std::string const &fname, bool fill_valid_tree) {
+  fhicl::ParameterSet tool_ps;
+  tool_ps.put("tool_type", std::string("MiscInteractionSysts"));
+  tool_ps.put("instance_name", std::string("Misc"));
+  tool_ps.put("nuenumu_xsec_ratio_variation_descriptor", std::string("[-1,1]"));
+  tool_ps.put("fill_valid_tree", fill_valid_tree);
+
+  fhicl::ParameterSet in_ps;
+  in_ps.put("Misc_toolconfig", tool_ps);
+  in_ps.put("syst_providers", std::vector<std::string>{"Misc_toolconfig"});
+
+  std::vector<std::unique_ptr<nusyst::IGENIESystProvider_tool>> tools =
+      systtools::ConfigureISystProvidersFromToolConfig<
+          nusyst::IGENIESystProvider_tool>(in_ps, nusyst::make_instance,
+                                           "syst_providers");
+
+  fhicl::ParameterSet out_ps;
+  std::vector<std::string> providerNames;
+  for (auto &prov : tools) {
+    out_ps.put(prov->GetFullyQualifiedName(),
+               prov->GetParameterHeadersDocument());
+    providerNames.push_back(prov->GetFullyQualifiedName());
+  }
+  out_ps.put("syst_providers", providerNames);
+
+  fhicl::ParameterSet wrapped_out_ps;
+  wrapped_out_ps.put("generated_systematic_provider_configuration", out_ps);
+
+  std::ofstream fs(fname);
+  fs << wrapped_out_ps.to_indented_string() << std::endl;
+}
+
+int main() {
+  // Every instance would write MiscInteractionSysts_valid.root.
+  WriteConfig("parallel_response_helper_valid.fcl", true);
+  try {
+    nusyst::parallel_response_helper phh(
+        "parallel_response_helper_valid.fcl", 2);
+    std::cout << "[ERROR]: Expected a provider filling a validation tree to "
+                 "be refused parallel replicas."
+              << std::endl;
+    return 1;
+  } catch (nusyst::parallel_response_helper_invalid_configuration const &e) {
+    std::cout << "[INFO]: Refused as expected: " << e.what() << std::endl;
+  }
+
+  WriteConfig("parallel_response_helper.fcl", false);
+  nusyst::parallel_response_helper phh("parallel_response_helper.fcl", 2);
+  if (phh.GetNThreads() != 2) {
+    std::cout << "[ERROR]: Expected two replicas, built " << phh.GetNThreads()
+              << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "nusystematics/utility/GENIEUtils.hh"
+#include "nusystematics/utility/exceptions.hh"
+#include "nusystematics/utility/simbUtility.hh"
+
+#include "Framework/EventGen/EventRecord.h"
+#include "Framework/GHEP/GHepParticle.h"
+#include "Framework/Interaction/KineVar.h"
+
+#include "TLorentzVector.h"
+
+namespace nusyst {
+
+/// Lepton kinematics and interaction classification shared by many
+/// providers, extracted from a GHep record once per event by
+/// BuildEventKinematics.
+///
+/// Quantities that GENIE does not always define for an event (the hit
+/// nucleon topology and the selected W) are flagged, use the GetQELikeTarget
+/// and GetW overloads below to get the same behaviour as the
+/// genie::EventRecord versions.
+struct EventKinematics {
+  genie::GHepParticle *ISLep;
+  genie::GHepParticle *FSLep;
+  /// False if either the probe or the final state primary lepton is missing.
+  bool HasLeptons;
+
+  TLorentzVector ISLepP4;
+  TLorentzVector FSLepP4;
+  TLorentzVector emTransfer;
+
+  int nu_pdg;
+  bool IsCC;
+  bool IsNC;
+  bool IsCharm;
+  simb_mode_copy mode;
+
+  double Enu;
+  double q0;
+  double q3;
+  double Q2;
+
+  bool HasW;
+  double W;
+
+  bool HasQELikeTarget;
+  QELikeTarget_t qel_target;
+};
+
+inline EventKinematics BuildEventKinematics(genie::EventRecord const &ev) {
+  EventKinematics kin;
+
+  kin.ISLep = ev.Probe();
+  kin.FSLep = ev.FinalStatePrimaryLepton();
+  kin.HasLeptons = kin.ISLep && kin.FSLep;
+
+  kin.nu_pdg = kin.ISLep ? kin.ISLep->Pdg() : 0;
+  kin.IsCC = ev.Summary()->ProcInfo().IsWeakCC();
+  kin.IsNC = ev.Summary()->ProcInfo().IsWeakNC();
+  kin.IsCharm = ev.Summary()->ExclTag().IsCharmEvent();
+  kin.mode = GetSimbMode(ev);
+
+  if (kin.ISLep) {
+    kin.ISLepP4 = *kin.ISLep->P4();
+  }
+  if (kin.FSLep) {
+    kin.FSLepP4 = *kin.FSLep->P4();
+  }
+  if (kin.HasLeptons) {
+    kin.emTransfer = (kin.ISLepP4 - kin.FSLepP4);
+  }
+  kin.Enu = kin.ISLepP4.E();
+  kin.q0 = kin.emTransfer.E();
+  kin.q3 = kin.emTransfer.Vect().Mag();
+  kin.Q2 = -kin.emTransfer.Mag2();
+
+  // Avoid GENIE warning about unset kinematics for every event that does not
+  // define W.
+  kin.HasW = ev.Summary()->Kine().KVSet(genie::kKVSelW);
+  kin.W = kin.HasW ? ev.Summary()->Kine().W(true) : 0;
+
+  try {
+    kin.qel_target = GetQELikeTarget(ev);
+    kin.HasQELikeTarget = true;
+  } catch (indeterminable_QELikeTarget const &) {
+    kin.qel_target = QELikeTarget_t::kInvalidTopology;
+    kin.HasQELikeTarget = false;
+  }
+
+  return kin;
+}
+
+/// Throws indeterminable_QELikeTarget in the same cases as
+/// GetQELikeTarget(genie::EventRecord const &).
+inline QELikeTarget_t GetQELikeTarget(genie::EventRecord const &ev,
+                                      EventKinematics const &kin) {
+  return kin.HasQELikeTarget ? kin.qel_target : GetQELikeTarget(ev);
+}
+
+inline double GetW(genie::EventRecord const &ev, EventKinematics const &kin) {
+  return kin.HasW ? kin.W : ev.Summary()->Kine().W(true);
+}
+
+} // namespace nusyst
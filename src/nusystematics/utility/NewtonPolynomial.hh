@@ -0,0 +1,72 @@
+#pragma once
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <array>
+#include <cstddef>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(too_many_polynomial_points);
+
+/// The polynomial of order NPoints-1 passing exactly through up to MaxPoints
+/// points, stored in Newton form.
+///
+/// Unlike a least-squares fit, building one is a handful of divided
+/// differences on the stack, so it is cheap enough to construct per event.
+template <size_t MaxPoints> class NewtonPolynomial {
+  std::array<double, MaxPoints> Nodes;
+  std::array<double, MaxPoints> Coeffs;
+  size_t NPoints;
+
+public:
+  /// The x values must be distinct.
+  NewtonPolynomial(double const *x, double const *y, size_t NPoints)
+      : NPoints(NPoints) {
+    if (NPoints > MaxPoints) {
+      throw too_many_polynomial_points()
+          << "[ERROR]: Attempted to build a polynomial through " << NPoints
+          << " points, but this NewtonPolynomial supports at most "
+          << MaxPoints;
+    }
+    for (size_t i = 0; i < NPoints; ++i) {
+      Nodes[i] = x[i];
+      Coeffs[i] = y[i];
+    }
+    for (size_t j = 1; j < NPoints; ++j) {
+      for (size_t i = NPoints - 1; i >= j; --i) {
+        Coeffs[i] = (Coeffs[i] - Coeffs[i - 1]) / (Nodes[i] - Nodes[i - j]);
+      }
+    }
+  }
+
+  double eval(double v) const {
+    if (!NPoints) {
+      return 0;
+    }
+    double rtn = Coeffs[NPoints - 1];
+    for (size_t i = NPoints - 1; i > 0; --i) {
+      rtn = rtn * (v - Nodes[i - 1]) + Coeffs[i - 1];
+    }
+    return rtn;
+  }
+
+  /// The coefficients of the same polynomial in increasing powers of v.
+  std::array<double, MaxPoints> GetMonomialCoefficients() const {
+    std::array<double, MaxPoints> mono{};
+    if (!NPoints) {
+      return mono;
+    }
+    mono[0] = Coeffs[NPoints - 1];
+    // As eval, but multiplying out each (v - Nodes[i - 1]) term.
+    for (size_t i = NPoints - 1; i > 0; --i) {
+      for (size_t k = NPoints - i; k > 0; --k) {
+        mono[k] = mono[k - 1] - (Nodes[i - 1] * mono[k]);
+      }
+      mono[0] = Coeffs[i - 1] - (Nodes[i - 1] * mono[0]);
+    }
+    return mono;
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace nusyst {
+
+/// Hardware performance counters for the calling thread, read with
+/// perf_event_open on Linux.
+///
+/// The counters are opened as a single group so that they are scheduled
+/// together. If perf_event_open is unavailable (non-Linux, containers,
+/// perf_event_paranoid restrictions, or virtual machines without a PMU) the
+/// group is simply not available and Read always fails; individual counters
+/// that the PMU does not support read as zero.
+///
+/// \note Counters only count the thread that opened them, so they must be
+/// opened on the thread that is to be measured.
+class PerfCounters {
+public:
+  enum counter_t {
+    kCycles = 0,
+    kInstructions,
+    kCacheMisses,
+    kBranchMisses,
+    NCounters
+  };
+  typedef std::array<uint64_t, NCounters> values_t;
+
+  static char const *CounterName(size_t c) {
+    switch (c) {
+    case kCycles: {
+      return "cycles";
+    }
+    case kInstructions: {
+      return "instructions";
+    }
+    case kCacheMisses: {
+      return "cache_misses";
+    }
+    case kBranchMisses: {
+      return "branch_misses";
+    }
+    default: { return "unknown"; }
+    }
+  }
+
+private:
+  std::array<int, NCounters> fds;
+  // Position of each counter in the group read, or NCounters if it could not
+  // be opened.
+  std::array<size_t, NCounters> ReadIndex;
+  size_t NOpen;
+  std::string Error;
+
+#ifdef __linux__
+  static int Open(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.disabled = (group_fd == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return int(syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0));
+  }
+#endif
+
+public:
+  PerfCounters() : NOpen(0) {
+    fds.fill(-1);
+    ReadIndex.fill(NCounters);
+#ifdef __linux__
+    static uint64_t const configs[NCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    fds[kCycles] = Open(configs[kCycles], -1);
+    if (fds[kCycles] == -1) {
+      Error = std::string("perf_event_open failed: ") + std::strerror(errno);
+      return;
+    }
+    ReadIndex[kCycles] = NOpen++;
+    for (size_t c_it = kCycles + 1; c_it < NCounters; ++c_it) {
+      fds[c_it] = Open(configs[c_it], fds[kCycles]);
+      if (fds[c_it] != -1) {
+        ReadIndex[c_it] = NOpen++;
+      }
+    }
+    ioctl(fds[kCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[kCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    Error = "hardware performance counters are only supported on Linux";
+#endif
+  }
+
+  PerfCounters(PerfCounters const &) = delete;
+  PerfCounters &operator=(PerfCounters const &) = delete;
+
+  ~PerfCounters() {
+#ifdef __linux__
+    for (int fd : fds) {
+      if (fd != -1) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  bool IsAvailable() const { return NOpen; }
+  bool IsAvailable(counter_t c) const { return ReadIndex[c] != NCounters; }
+  /// Why the counters are unavailable.
+  std::string const &GetError() const { return Error; }
+
+  /// Reads the current counts, returns false if unavailable.
+  bool Read(values_t &vals) const {
+#ifdef __linux__
+    if (!NOpen) {
+      return false;
+    }
+    uint64_t buf[1 + NCounters];
+    ssize_t bytes = read(fds[kCycles], buf, sizeof(buf));
+    if ((bytes < ssize_t(sizeof(uint64_t))) || (buf[0] != NOpen)) {
+      return false;
+    }
+    for (size_t c_it = 0; c_it < NCounters; ++c_it) {
+      vals[c_it] = (ReadIndex[c_it] == NCounters) ? 0 : buf[1 + ReadIndex[c_it]];
+    }
+    return true;
+#else
+    (void)vals;
+    return false;
+#endif
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace nusyst {
+
+/// The resident set size of this process in bytes, read from
+/// /proc/self/statm, or 0 where that is not available.
+///
+/// Differences taken around an allocation are a reasonable estimate of the
+/// memory it holds, but are not attributable to one thread while others are
+/// allocating.
+inline int64_t GetResidentSetBytes() {
+  std::ifstream statm("/proc/self/statm");
+  int64_t NPages = 0, NResidentPages = 0;
+  if (!(statm >> NPages >> NResidentPages)) {
+    return 0;
+  }
+  return NResidentPages * int64_t(sysconf(_SC_PAGESIZE));
+}
+
+} // namespace nusyst
@@ -0,0 +1,455 @@
+#pragma once
+
+#include "nusystematics/interface/EventApplicability.hh"
+#include "nusystematics/interface/ParameterSlots.hh"
+
+#include "nusystematics/utility/PerfCounters.hh"
+#include "nusystematics/utility/enumclass2int.hh"
+#include "nusystematics/utility/simbUtility.hh"
+
+#include "systematicstools/interface/types.hh"
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include "TDirectory.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(incompatible_response_profiler);
+
+/// Fixed-size log-linear histogram of latencies in nanoseconds.
+///
+/// Latencies below NLinear ns get a bin each, above that every power of two
+/// is split into NSubBins bins, so that quantiles are resolved to within
+/// 12.5% over the full range of uint64_t. Storage is allocated on the first
+/// Add.
+class LatencyHistogram {
+public:
+  constexpr static size_t NSubBinBits = 3;
+  constexpr static size_t NSubBins = size_t(1) << NSubBinBits;
+  constexpr static size_t NLinear = 2 * NSubBins;
+  constexpr static size_t NBins = NLinear + (64 - 4) * NSubBins;
+
+private:
+  std::vector<uint64_t> Counts;
+  uint64_t N;
+  uint64_t Max;
+  double Sum_ns;
+
+  static size_t Log2(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    size_t l = 0;
+    while (v >>= 1) {
+      ++l;
+    }
+    return l;
+#endif
+  }
+
+public:
+  LatencyHistogram() : N(0), Max(0), Sum_ns(0) {}
+
+  static size_t Bin(uint64_t ns) {
+    if (ns < NLinear) {
+      return size_t(ns);
+    }
+    size_t exp = Log2(ns);
+    size_t sub = (ns >> (exp - NSubBinBits)) & (NSubBins - 1);
+    return NLinear + (exp - 4) * NSubBins + sub;
+  }
+  static double BinLowEdge(size_t bin) {
+    if (bin < NLinear) {
+      return double(bin);
+    }
+    size_t exp = ((bin - NLinear) / NSubBins) + 4;
+    size_t sub = (bin - NLinear) % NSubBins;
+    return double(NSubBins + sub) * double(uint64_t(1) << (exp - NSubBinBits));
+  }
+  static double BinUpEdge(size_t bin) {
+    return (bin + 1 < NBins) ? BinLowEdge(bin + 1)
+                             : double(std::numeric_limits<uint64_t>::max());
+  }
+
+  void Add(uint64_t ns) {
+    if (Counts.empty()) {
+      Counts.assign(NBins, 0);
+    }
+    Counts[Bin(ns)]++;
+    N++;
+    Sum_ns += double(ns);
+    Max = std::max(Max, ns);
+  }
+
+  void Merge(LatencyHistogram const &other) {
+    if (!other.N) {
+      return;
+    }
+    if (Counts.empty()) {
+      Counts.assign(NBins, 0);
+    }
+    for (size_t b_it = 0; b_it < NBins; ++b_it) {
+      Counts[b_it] += other.Counts[b_it];
+    }
+    N += other.N;
+    Sum_ns += other.Sum_ns;
+    Max = std::max(Max, other.Max);
+  }
+
+  uint64_t GetN() const { return N; }
+  double GetSum_ns() const { return Sum_ns; }
+  double GetMean_ns() const { return N ? (Sum_ns / double(N)) : 0; }
+  double GetMax_ns() const { return double(Max); }
+
+  /// Upper edge of the bin containing the q-th quantile, clamped to the
+  /// largest recorded latency.
+  double GetQuantile_ns(double q) const {
+    if (!N) {
+      return 0;
+    }
+    uint64_t target =
+        std::max(uint64_t(1), uint64_t(std::ceil(q * double(N))));
+    uint64_t cumulative = 0;
+    for (size_t b_it = 0; b_it < NBins; ++b_it) {
+      cumulative += Counts[b_it];
+      if (cumulative >= target) {
+        return std::min(BinUpEdge(b_it), GetMax_ns());
+      }
+    }
+    return GetMax_ns();
+  }
+};
+
+/// Latency of provider responses per provider x interaction mode, and per
+/// parameter x interaction mode for providers that time their parameters
+/// individually.
+///
+/// A profiler is only ever written to by the thread that owns the
+/// response_helper it belongs to, so recording takes no locks; profiles from
+/// several threads are combined with Merge once they are idle. All storage is
+/// indexed by dense provider and parameter indices.
+class ResponseProfiler {
+public:
+  typedef std::chrono::steady_clock clock;
+
+private:
+  std::vector<std::string> ProviderNames;
+
+  ParameterSlots ParamSlots;
+  std::vector<std::string> ParamNames;
+  std::vector<size_t> ParamProviders;
+
+  // [provider|parameter][mode]
+  std::vector<LatencyHistogram> ProviderHists;
+  std::vector<LatencyHistogram> ParamHists;
+
+  // Summed hardware counter deltas and the number of calls that they were
+  // read for, [provider][mode].
+  std::vector<PerfCounters::values_t> ProviderCounts;
+  std::vector<uint64_t> ProviderNCounted;
+  bool HasCounters;
+
+  // The wall clock window from the start of the first recorded call to the
+  // end of the last, so that call rates exclude setup and any idle time
+  // after processing.
+  bool HasCalls;
+  clock::time_point First, Last;
+
+  uint64_t Since(clock::time_point start) {
+    clock::time_point end = clock::now();
+    if (!HasCalls || (start < First)) {
+      First = start;
+    }
+    if (!HasCalls || (end > Last)) {
+      Last = end;
+    }
+    HasCalls = true;
+    return uint64_t(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+            .count());
+  }
+
+  struct Row {
+    std::string provider;
+    std::string parameter;
+    std::string mode;
+    LatencyHistogram const *hist;
+    /// Null if no counters were read.
+    PerfCounters::values_t const *counts;
+    uint64_t NCounted;
+
+    /// Mean count per call of counter c.
+    double PerCall(size_t c) const {
+      return NCounted ? (double((*counts)[c]) / double(NCounted)) : 0;
+    }
+    double IPC() const {
+      return (*counts)[PerfCounters::kCycles]
+                 ? (double((*counts)[PerfCounters::kInstructions]) /
+                    double((*counts)[PerfCounters::kCycles]))
+                 : 0;
+    }
+  };
+
+  std::vector<Row> GetRows() const {
+    std::vector<Row> rows;
+    for (size_t sp_it = 0; sp_it < ProviderNames.size(); ++sp_it) {
+      for (size_t m_it = 0; m_it < EventApplicability::NModes; ++m_it) {
+        size_t h_it = sp_it * EventApplicability::NModes + m_it;
+        LatencyHistogram const &h = ProviderHists[h_it];
+        if (h.GetN()) {
+          rows.push_back(
+              {ProviderNames[sp_it], "", ModeName(m_it), &h,
+               ProviderNCounted[h_it] ? &ProviderCounts[h_it] : nullptr,
+               ProviderNCounted[h_it]});
+        }
+      }
+      for (size_t p_it = 0; p_it < ParamNames.size(); ++p_it) {
+        if (ParamProviders[p_it] != sp_it) {
+          continue;
+        }
+        for (size_t m_it = 0; m_it < EventApplicability::NModes; ++m_it) {
+          LatencyHistogram const &h =
+              ParamHists[p_it * EventApplicability::NModes + m_it];
+          if (h.GetN()) {
+            rows.push_back({ProviderNames[sp_it], ParamNames[p_it],
+                            ModeName(m_it), &h, nullptr, 0});
+          }
+        }
+      }
+    }
+    return rows;
+  }
+
+  static std::string ModeName(size_t mode_idx) {
+    return tostr(static_cast<simb_mode_copy>(int(mode_idx) - 1));
+  }
+
+  static std::string JSONEscape(std::string const &s) {
+    std::string out;
+    for (char c : s) {
+      if ((c == '"') || (c == '\\')) {
+        out += '\\';
+      }
+      out += c;
+    }
+    return out;
+  }
+
+public:
+  ResponseProfiler()
+      : HasCounters(false), HasCalls(false) {}
+
+  /// Returns the provider index to pass to RecordProvider.
+  size_t AddProvider(std::string const &name) {
+    ProviderNames.push_back(name);
+    ProviderHists.resize(ProviderNames.size() * EventApplicability::NModes);
+    ProviderCounts.resize(ProviderHists.size(), PerfCounters::values_t{});
+    ProviderNCounted.resize(ProviderHists.size(), 0);
+    return ProviderNames.size() - 1;
+  }
+  void AddParameter(size_t provider, systtools::paramId_t pid,
+                    std::string const &name) {
+    ParamSlots.Add(pid);
+    ParamNames.push_back(name);
+    ParamProviders.push_back(provider);
+    ParamHists.resize(ParamNames.size() * EventApplicability::NModes);
+  }
+
+  /// The wall time spanned by the recorded calls, used to calculate call
+  /// rates.
+  double GetElapsed_s() const {
+    return HasCalls ? std::chrono::duration<double>(Last - First).count() : 0;
+  }
+
+  /// mode_idx is EventApplicability::ModeIndex of the event mode.
+  void RecordProvider(size_t provider, size_t mode_idx,
+                      clock::time_point start) {
+    ProviderHists[provider * EventApplicability::NModes + mode_idx].Add(
+        Since(start));
+  }
+  /// Adds the hardware counter deltas between begin and end.
+  void RecordProviderCounters(size_t provider, size_t mode_idx,
+                              PerfCounters::values_t const &begin,
+                              PerfCounters::values_t const &end) {
+    size_t h_it = provider * EventApplicability::NModes + mode_idx;
+    for (size_t c_it = 0; c_it < PerfCounters::NCounters; ++c_it) {
+      ProviderCounts[h_it][c_it] += end[c_it] - begin[c_it];
+    }
+    ProviderNCounted[h_it]++;
+    HasCounters = true;
+  }
+  /// Parameters that were not added are ignored.
+  void RecordParameter(systtools::paramId_t pid, size_t mode_idx,
+                       clock::time_point start) {
+    size_t p_it = ParamSlots.GetSlot(pid);
+    if (p_it == systtools::kParamUnhandled<size_t>) {
+      return;
+    }
+    ParamHists[p_it * EventApplicability::NModes + mode_idx].Add(Since(start));
+  }
+
+  /// Adds the latencies recorded by an identically configured profiler. As
+  /// the profilers run concurrently, the elapsed time spans the calls recorded
+  /// by either.
+  void Merge(ResponseProfiler const &other) {
+    if ((other.ProviderNames != ProviderNames) ||
+        (other.ParamNames != ParamNames)) {
+      throw incompatible_response_profiler()
+          << "[ERROR]: Attempted to merge ResponseProfilers with different "
+             "providers or parameters.";
+    }
+    for (size_t h_it = 0; h_it < ProviderHists.size(); ++h_it) {
+      ProviderHists[h_it].Merge(other.ProviderHists[h_it]);
+      for (size_t c_it = 0; c_it < PerfCounters::NCounters; ++c_it) {
+        ProviderCounts[h_it][c_it] += other.ProviderCounts[h_it][c_it];
+      }
+      ProviderNCounted[h_it] += other.ProviderNCounted[h_it];
+    }
+    HasCounters = HasCounters || other.HasCounters;
+    for (size_t h_it = 0; h_it < ParamHists.size(); ++h_it) {
+      ParamHists[h_it].Merge(other.ParamHists[h_it]);
+    }
+    if (other.HasCalls) {
+      First = HasCalls ? std::min(First, other.First) : other.First;
+      Last = HasCalls ? std::max(Last, other.Last) : other.Last;
+      HasCalls = true;
+    }
+  }
+
+  /// Human readable summary, latencies in us.
+  void Print(std::ostream &os) const {
+    double elapsed = GetElapsed_s();
+    std::string last_provider;
+    for (Row const &r : GetRows()) {
+      if (r.provider != last_provider) {
+        os << "\tSystProvider: " << r.provider << std::endl;
+        last_provider = r.provider;
+      }
+      os << "\t\t" << (r.parameter.size() ? ("Param: " + r.parameter + ", ") : "")
+         << "Mode: " << r.mode << ", NCalls = " << r.hist->GetN()
+         << ", mean: " << (r.hist->GetMean_ns() * 1E-3)
+         << " us, p50: " << (r.hist->GetQuantile_ns(0.5) * 1E-3)
+         << " us, p95: " << (r.hist->GetQuantile_ns(0.95) * 1E-3)
+         << " us, p99: " << (r.hist->GetQuantile_ns(0.99) * 1E-3)
+         << " us, max: " << (r.hist->GetMax_ns() * 1E-3) << " us, "
+         << (elapsed > 0 ? (double(r.hist->GetN()) / elapsed) : 0)
+         << " calls/s.";
+      if (r.counts) {
+        os << " Per call: "
+           << r.PerCall(PerfCounters::kCycles) << " cycles, "
+           << r.PerCall(PerfCounters::kInstructions) << " instructions (IPC "
+           << r.IPC() << "), " << r.PerCall(PerfCounters::kCacheMisses)
+           << " cache misses, " << r.PerCall(PerfCounters::kBranchMisses)
+           << " branch misses.";
+      }
+      os << std::endl;
+    }
+  }
+
+  void WriteJSON(std::ostream &os) const {
+    double elapsed = GetElapsed_s();
+    std::streamsize precision = os.precision(9);
+    os << "{\n  \"elapsed_s\": " << elapsed
+       << ",\n  \"entries\": [";
+    bool first = true;
+    for (Row const &r : GetRows()) {
+      os << (first ? "\n" : ",\n") << "    {\"provider\": \""
+         << JSONEscape(r.provider) << "\", \"parameter\": \""
+         << JSONEscape(r.parameter) << "\", \"mode\": \"" << r.mode
+         << "\", \"ncalls\": " << r.hist->GetN()
+         << ", \"total_ms\": " << (r.hist->GetSum_ns() * 1E-6)
+         << ", \"mean_us\": " << (r.hist->GetMean_ns() * 1E-3)
+         << ", \"p50_us\": " << (r.hist->GetQuantile_ns(0.5) * 1E-3)
+         << ", \"p95_us\": " << (r.hist->GetQuantile_ns(0.95) * 1E-3)
+         << ", \"p99_us\": " << (r.hist->GetQuantile_ns(0.99) * 1E-3)
+         << ", \"max_us\": " << (r.hist->GetMax_ns() * 1E-3)
+         << ", \"calls_per_s\": "
+         << (elapsed > 0 ? (double(r.hist->GetN()) / elapsed) : 0);
+      if (r.counts) {
+        os << ", \"ncounted\": " << r.NCounted;
+        for (size_t c_it = 0; c_it < PerfCounters::NCounters; ++c_it) {
+          os << ", \"" << PerfCounters::CounterName(c_it)
+             << "\": " << (*r.counts)[c_it];
+        }
+        os << ", \"ipc\": " << r.IPC();
+      }
+      os << "}";
+      first = false;
+    }
+    os << "\n  ]\n}" << std::endl;
+    os.precision(precision);
+  }
+
+  /// Writes a response_profile TTree to dir with one entry per provider (or
+  /// parameter) x mode that was called, parameter is empty for whole-provider
+  /// entries.
+  void WriteTree(TDirectory *dir) const {
+    if (!dir) {
+      throw incompatible_response_profiler()
+          << "[ERROR]: Attempted to write a ResponseProfiler to a null "
+             "TDirectory.";
+    }
+
+    std::string provider, parameter, mode;
+    ULong64_t ncalls;
+    double total_ms, mean_us, p50_us, p95_us, p99_us, max_us, calls_per_s;
+    // Per-call means, zero when counters were not read.
+    double counters_per_call[PerfCounters::NCounters];
+
+    TTree *t = new TTree("response_profile", "");
+    t->SetDirectory(dir);
+    t->Branch("provider", &provider);
+    t->Branch("parameter", &parameter);
+    t->Branch("mode", &mode);
+    t->Branch("ncalls", &ncalls, "ncalls/l");
+    t->Branch("total_ms", &total_ms, "total_ms/D");
+    t->Branch("mean_us", &mean_us, "mean_us/D");
+    t->Branch("p50_us", &p50_us, "p50_us/D");
+    t->Branch("p95_us", &p95_us, "p95_us/D");
+    t->Branch("p99_us", &p99_us, "p99_us/D");
+    t->Branch("max_us", &max_us, "max_us/D");
+    t->Branch("calls_per_s", &calls_per_s, "calls_per_s/D");
+    if (HasCounters) {
+      for (size_t c_it = 0; c_it < PerfCounters::NCounters; ++c_it) {
+        std::string bname = std::string(PerfCounters::CounterName(c_it)) +
+                            "_per_call";
+        t->Branch(bname.c_str(), &counters_per_call[c_it],
+                  (bname + "/D").c_str());
+      }
+    }
+
+    double elapsed = GetElapsed_s();
+    for (Row const &r : GetRows()) {
+      provider = r.provider;
+      parameter = r.parameter;
+      mode = r.mode;
+      ncalls = r.hist->GetN();
+      total_ms = r.hist->GetSum_ns() * 1E-6;
+      mean_us = r.hist->GetMean_ns() * 1E-3;
+      p50_us = r.hist->GetQuantile_ns(0.5) * 1E-3;
+      p95_us = r.hist->GetQuantile_ns(0.95) * 1E-3;
+      p99_us = r.hist->GetQuantile_ns(0.99) * 1E-3;
+      max_us = r.hist->GetMax_ns() * 1E-3;
+      calls_per_s = (elapsed > 0) ? (double(ncalls) / elapsed) : 0;
+      for (size_t c_it = 0; c_it < PerfCounters::NCounters; ++c_it) {
+        counters_per_call[c_it] = r.counts ? r.PerCall(c_it) : 0;
+      }
+      t->Fill();
+    }
+    dir->WriteTObject(t);
+    delete t;
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace nusyst {
+
+/// Emulates the responses of one parameter to an event from the mean of the
+/// exactly calculated responses of similar events, trained on the fly.
+///
+/// Events are binned by a caller-defined event class, the target and a
+/// uniform binning in each kinematic variable. A fixed fraction of events, and
+/// every event falling in a bin with fewer than MinEntries training events, is
+/// calculated exactly by the caller and passed to Train; the rest are
+/// emulated. Training events falling in an already trained bin are first
+/// compared to the emulated responses, which gives an out-of-sample estimate
+/// of the emulation error.
+///
+/// Not thread safe, callers sharing a surrogate must serialise access.
+class ResponseSurrogate {
+public:
+  /// A uniform binning, values outside of [Min, Max) are placed in the first
+  /// or last bin.
+  struct Axis {
+    size_t NBins;
+    double Min, Max;
+
+    size_t GetBin(double v) const {
+      if (!(v > Min)) {
+        return 0;
+      }
+      size_t bin = size_t(NBins * (v - Min) / (Max - Min));
+      return std::min(bin, NBins - 1);
+    }
+  };
+
+  /// Event class, target PDG code and flattened kinematic bin.
+  typedef std::tuple<size_t, int, size_t> key_t;
+
+  struct Diagnostics {
+    size_t NTrain = 0;
+    size_t NEmulated = 0;
+    /// Training events that were compared to the emulated responses.
+    size_t NChecked = 0;
+    /// Over every variation of every checked event.
+    size_t NResiduals = 0;
+    double SumResidual = 0;
+    double SumSqResidual = 0;
+    double MaxAbsResidual = 0;
+
+    double MeanResidual() const {
+      return NResiduals ? (SumResidual / NResiduals) : 0;
+    }
+    double RMSResidual() const {
+      return NResiduals ? std::sqrt(SumSqResidual / NResiduals) : 0;
+    }
+  };
+
+private:
+  struct Bin {
+    size_t N = 0;
+    std::vector<double> Sum;
+  };
+
+  size_t NVariations;
+  std::vector<Axis> Axes;
+  double TrainingFraction;
+  size_t MinEntries;
+
+  std::map<key_t, Bin> Bins;
+  size_t NSeen;
+  Diagnostics Diag;
+
+public:
+  ResponseSurrogate(size_t NVariations, std::vector<Axis> axes,
+                    double TrainingFraction, size_t MinEntries)
+      : NVariations(NVariations), Axes(std::move(axes)),
+        TrainingFraction(TrainingFraction),
+        MinEntries(std::max(size_t(1), MinEntries)), NSeen(0) {}
+
+  /// kin must hold one value per axis.
+  key_t GetKey(size_t event_class, int target_pdg, double const *kin) const {
+    size_t kin_bin = 0;
+    for (size_t ax_it = 0; ax_it < Axes.size(); ++ax_it) {
+      kin_bin = (kin_bin * Axes[ax_it].NBins) + Axes[ax_it].GetBin(kin[ax_it]);
+    }
+    return key_t{event_class, target_pdg, kin_bin};
+  }
+
+  /// Fills responses and returns true if this event should be emulated,
+  /// otherwise returns false and the caller should calculate the responses
+  /// exactly and pass them to Train.
+  bool Emulate(key_t const &key, double *responses) {
+    ++NSeen;
+    // Spreads the training events evenly through the sample.
+    bool IsTraining = std::floor(NSeen * TrainingFraction) !=
+                      std::floor((NSeen - 1) * TrainingFraction);
+    if (IsTraining) {
+      return false;
+    }
+    auto bin_it = Bins.find(key);
+    if ((bin_it == Bins.end()) || (bin_it->second.N < MinEntries)) {
+      return false;
+    }
+    for (size_t var_it = 0; var_it < NVariations; ++var_it) {
+      responses[var_it] = bin_it->second.Sum[var_it] / bin_it->second.N;
+    }
+    Diag.NEmulated++;
+    return true;
+  }
+
+  void Train(key_t const &key, double const *responses) {
+    Bin &bin = Bins[key];
+    if (bin.N >= MinEntries) {
+      for (size_t var_it = 0; var_it < NVariations; ++var_it) {
+        double residual = (bin.Sum[var_it] / bin.N) - responses[var_it];
+        Diag.SumResidual += residual;
+        Diag.SumSqResidual += residual * residual;
+        Diag.MaxAbsResidual =
+            std::max(Diag.MaxAbsResidual, std::fabs(residual));
+      }
+      Diag.NResiduals += NVariations;
+      Diag.NChecked++;
+    }
+    bin.Sum.resize(NVariations, 0);
+    for (size_t var_it = 0; var_it < NVariations; ++var_it) {
+      bin.Sum[var_it] += responses[var_it];
+    }
+    bin.N++;
+    Diag.NTrain++;
+  }
+
+  Diagnostics const &GetDiagnostics() const { return Diag; }
+  size_t GetNFilledBins() const { return Bins.size(); }
+};
+
+} // namespace nusyst
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace nusyst {
+
+/// Process-wide recorder of begin/end spans, written out as Chrome trace
+/// JSON (viewable with chrome://tracing or ui.perfetto.dev).
+///
+/// Each thread records into its own fixed-size ring buffer, so that a long
+/// job keeps the most recent spans and recording never takes a lock. Span
+/// names are interned once, typically at setup, and referred to by id.
+/// When tracing is disabled a TraceSpan costs a single relaxed atomic load.
+class ResponseTracer {
+public:
+  typedef std::chrono::steady_clock clock;
+  typedef uint32_t name_id_t;
+
+  constexpr static int32_t kNoArg = -1;
+
+private:
+  struct Span {
+    name_id_t name;
+    int32_t arg;
+    int64_t begin_ns;
+    int64_t dur_ns;
+  };
+
+  struct ThreadBuffer {
+    size_t tid;
+    std::vector<Span> Spans;
+    // Total number of spans recorded, the buffer holds the last
+    // Spans.size() of them.
+    uint64_t NRecorded;
+  };
+
+  std::atomic<bool> Enabled;
+  size_t BufferSize;
+  clock::time_point Epoch;
+
+  std::mutex m;
+  std::vector<std::string> Names;
+  std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+
+  ResponseTracer()
+      : Enabled(false), BufferSize(size_t(1) << 20), Epoch(clock::now()) {}
+
+  ThreadBuffer &GetThreadBuffer() {
+    thread_local ThreadBuffer *tb = nullptr;
+    if (!tb) {
+      std::lock_guard<std::mutex> lock(m);
+      Buffers.emplace_back(std::make_unique<ThreadBuffer>());
+      tb = Buffers.back().get();
+      tb->tid = Buffers.size();
+      tb->Spans.resize(BufferSize);
+      tb->NRecorded = 0;
+    }
+    return *tb;
+  }
+
+  static void WriteJSONString(std::ostream &os, std::string const &s) {
+    os << '"';
+    for (char c : s) {
+      if ((c == '"') || (c == '\\')) {
+        os << '\\';
+      }
+      os << c;
+    }
+    os << '"';
+  }
+
+public:
+  static ResponseTracer &Get() {
+    static ResponseTracer tracer;
+    return tracer;
+  }
+
+  ResponseTracer(ResponseTracer const &) = delete;
+  ResponseTracer &operator=(ResponseTracer const &) = delete;
+
+  /// buffer_size is the number of spans kept per thread, it only applies to
+  /// threads that have not yet recorded a span.
+  void Enable(size_t buffer_size = size_t(1) << 20) {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      BufferSize = buffer_size ? buffer_size : 1;
+    }
+    Enabled.store(true, std::memory_order_relaxed);
+  }
+  void Disable() { Enabled.store(false, std::memory_order_relaxed); }
+  bool IsEnabled() const { return Enabled.load(std::memory_order_relaxed); }
+
+  /// Returns the id for name, repeated calls with the same name return the
+  /// same id.
+  name_id_t Intern(std::string const &name) {
+    std::lock_guard<std::mutex> lock(m);
+    for (size_t n_it = 0; n_it < Names.size(); ++n_it) {
+      if (Names[n_it] == name) {
+        return name_id_t(n_it);
+      }
+    }
+    Names.push_back(name);
+    return name_id_t(Names.size() - 1);
+  }
+
+  void Record(name_id_t name, clock::time_point begin, clock::time_point end,
+              int32_t arg = kNoArg) {
+    ThreadBuffer &tb = GetThreadBuffer();
+    Span &s = tb.Spans[tb.NRecorded % tb.Spans.size()];
+    s.name = name;
+    s.arg = arg;
+    s.begin_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(begin - Epoch)
+            .count();
+    s.dur_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin)
+            .count();
+    tb.NRecorded++;
+  }
+
+  /// Writes all buffered spans as Chrome trace JSON.
+  ///
+  /// \note Threads must not be recording spans concurrently.
+  void WriteJSON(std::ostream &os) {
+    std::lock_guard<std::mutex> lock(m);
+    std::streamsize precision = os.precision(15);
+    os << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+    bool first = true;
+    for (auto const &tb : Buffers) {
+      os << (first ? "\n" : ",\n")
+         << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+            "\"tid\": "
+         << tb->tid << ", \"args\": {\"name\": \"worker " << tb->tid
+         << "\"}}";
+      first = false;
+
+      uint64_t NSpans = std::min(uint64_t(tb->Spans.size()), tb->NRecorded);
+      for (uint64_t s_it = tb->NRecorded - NSpans; s_it < tb->NRecorded;
+           ++s_it) {
+        Span const &s = tb->Spans[s_it % tb->Spans.size()];
+        os << ",\n{\"name\": ";
+        WriteJSONString(os, Names[s.name]);
+        os << ", \"cat\": \"nusyst\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+           << tb->tid << ", \"ts\": " << (double(s.begin_ns) * 1E-3)
+           << ", \"dur\": " << (double(s.dur_ns) * 1E-3);
+        if (s.arg != kNoArg) {
+          os << ", \"args\": {\"index\": " << s.arg << "}";
+        }
+        os << "}";
+      }
+    }
+    os << "\n]}" << std::endl;
+    os.precision(precision);
+  }
+};
+
+/// Records a span from construction to destruction if tracing is enabled.
+class TraceSpan {
+  ResponseTracer::name_id_t name;
+  int32_t arg;
+  bool active;
+  ResponseTracer::clock::time_point begin;
+
+public:
+  explicit TraceSpan(ResponseTracer::name_id_t n,
+                     int32_t a = ResponseTracer::kNoArg)
+      : name(n), arg(a), active(ResponseTracer::Get().IsEnabled()) {
+    if (active) {
+      begin = ResponseTracer::clock::now();
+    }
+  }
+  TraceSpan(TraceSpan const &) = delete;
+  TraceSpan &operator=(TraceSpan const &) = delete;
+  ~TraceSpan() {
+    if (active) {
+      ResponseTracer::Get().Record(name, begin, ResponseTracer::clock::now(),
+                                   arg);
+    }
+  }
+};
+
+} // namespace nusyst
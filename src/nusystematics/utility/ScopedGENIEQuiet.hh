@@ -0,0 +1,95 @@
+#pragma once
+
+#include "TH1.h"
+
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+
+namespace nusyst {
+
+/// Silences std::cout on the holding thread and enables TH1::AddDirectory, as
+/// GENIE weight calculators expect, for the lifetime of the outermost
+/// instance.
+///
+/// std::cout is only redirected once per process, by Install, to a buffer
+/// that forwards to the original one unless the writing thread holds a
+/// guard, so output from threads not in GENIE is unaffected and the buffer
+/// is never swapped while others may be writing. Hold one around a whole
+/// loop of CalcWeight calls rather than around each call.
+class ScopedGENIEQuiet {
+  class ThreadQuietStreamBuf : public std::streambuf {
+    std::streambuf *sink;
+
+  public:
+    explicit ThreadQuietStreamBuf(std::streambuf *sink) : sink(sink) {}
+
+  protected:
+    int overflow(int c) {
+      if (GetNHeld() || traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+      }
+      return sink->sputc(traits_type::to_char_type(c));
+    }
+    std::streamsize xsputn(char const *s, std::streamsize n) {
+      return GetNHeld() ? n : sink->sputn(s, n);
+    }
+    int sync() { return sink->pubsync(); }
+  };
+
+  /// Guards held by this thread.
+  static size_t &GetNHeld() {
+    static thread_local size_t NHeld = 0;
+    return NHeld;
+  }
+
+  /// TH1::AddDirectory is process-wide, so is switched when the first guard
+  /// on any thread is taken and restored when the last one is released.
+  struct AddDirectoryState {
+    std::mutex m;
+    size_t NHeld = 0;
+    bool was_add_dir = false;
+  };
+
+  static AddDirectoryState &GetAddDirectoryState() {
+    static AddDirectoryState state;
+    return state;
+  }
+
+public:
+  /// Installs the filtering std::cout buffer, if it is not already. Should be
+  /// called during setup, before any other threads are writing to std::cout.
+  static void Install() {
+    static std::once_flag installed;
+    std::call_once(installed, []() {
+      // Never deleted, as std::cout may be written to during static
+      // destruction.
+      std::cout.rdbuf(new ThreadQuietStreamBuf(std::cout.rdbuf()));
+    });
+  }
+
+  ScopedGENIEQuiet() {
+    Install();
+    GetNHeld()++;
+    AddDirectoryState &s = GetAddDirectoryState();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (!s.NHeld++) {
+      s.was_add_dir = TH1::AddDirectoryStatus();
+      TH1::AddDirectory(true);
+    }
+  }
+
+  ScopedGENIEQuiet(ScopedGENIEQuiet const &) = delete;
+  ScopedGENIEQuiet &operator=(ScopedGENIEQuiet const &) = delete;
+
+  ~ScopedGENIEQuiet() {
+    GetNHeld()--;
+    AddDirectoryState &s = GetAddDirectoryState();
+    std::lock_guard<std::mutex> lock(s.m);
+    if (!--s.NHeld) {
+      TH1::AddDirectory(s.was_add_dir);
+    }
+  }
+};
+
+} // namespace nusyst
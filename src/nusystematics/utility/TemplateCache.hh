@@ -0,0 +1,325 @@
+#pragma once
+
+#include "systematicstools/utility/exceptions.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(invalid_template_cache);
+
+/// A read-only view of one array of a TemplateCache record.
+struct TemplateCacheArray {
+  double const *data;
+  size_t size;
+};
+
+/// The layout shared by TemplateCacheWriter and TemplateCache.
+///
+/// A file is a FileHeader followed by NRecords records, each a RecordHeader,
+/// the key padded to 8 bytes, the size of each of NArrays arrays and then the
+/// array contents. Everything is 8-byte aligned, so arrays can be read in
+/// place from the mapped file.
+namespace template_cache {
+constexpr char const Magic[8] = {'N', 'U', 'S', 'Y', 'S', 'T', 'P', 'L'};
+constexpr uint32_t Version = 1;
+
+struct FileHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t NRecords;
+  /// The md5 of the generated provider configuration that was cached.
+  char ConfigMD5[32];
+  uint64_t PayloadBytes;
+  /// FNV-1a of the PayloadBytes following the header.
+  uint64_t PayloadChecksum;
+};
+
+struct RecordHeader {
+  uint64_t KeyLength;
+  uint64_t NArrays;
+};
+
+inline uint64_t Checksum(char const *data, size_t n) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < n; ++i) {
+    hash = (hash ^ uint64_t(uint8_t(data[i]))) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+inline size_t Padded(size_t n) { return (n + 7) & ~size_t(7); }
+} // namespace template_cache
+
+/// Collects template contents from configured providers and writes them as a
+/// single TemplateCache file, see BuildTemplateCacheNuSyst.
+class TemplateCacheWriter {
+  std::string ConfigMD5;
+  std::vector<char> Payload;
+  std::map<std::string, size_t> Keys;
+
+  void Append(void const *data, size_t n) {
+    char const *bytes = static_cast<char const *>(data);
+    Payload.insert(Payload.end(), bytes, bytes + n);
+    Payload.resize(template_cache::Padded(Payload.size()), 0);
+  }
+
+public:
+  explicit TemplateCacheWriter(std::string config_md5)
+      : ConfigMD5(std::move(config_md5)) {}
+
+  void AddRecord(std::string const &key,
+                 std::vector<std::vector<double>> const &arrays) {
+    if (Keys.count(key)) {
+      throw invalid_template_cache()
+          << "[ERROR]: Attempted to write template cache record " << key
+          << " twice.";
+    }
+    Keys[key] = arrays.size();
+
+    template_cache::RecordHeader hdr{key.size(), arrays.size()};
+    Append(&hdr, sizeof(hdr));
+    Append(key.data(), key.size());
+    std::vector<uint64_t> sizes;
+    for (auto const &arr : arrays) {
+      sizes.push_back(arr.size());
+    }
+    Append(sizes.data(), sizes.size() * sizeof(uint64_t));
+    for (auto const &arr : arrays) {
+      Append(arr.data(), arr.size() * sizeof(double));
+    }
+  }
+
+  size_t GetNRecords() const { return Keys.size(); }
+  size_t GetNBytes() const {
+    return sizeof(template_cache::FileHeader) + Payload.size();
+  }
+
+  /// Writes to a temporary file that is renamed over path, so that jobs
+  /// that have an existing cache at path mapped keep reading the old file.
+  void Write(std::string const &path) const {
+    template_cache::FileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.Magic, template_cache::Magic, sizeof(hdr.Magic));
+    hdr.Version = template_cache::Version;
+    hdr.NRecords = uint32_t(Keys.size());
+    std::memcpy(hdr.ConfigMD5, ConfigMD5.data(),
+                std::min(ConfigMD5.size(), sizeof(hdr.ConfigMD5)));
+    hdr.PayloadBytes = Payload.size();
+    hdr.PayloadChecksum =
+        template_cache::Checksum(Payload.data(), Payload.size());
+
+    std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<char const *>(&hdr), sizeof(hdr));
+    out.write(Payload.data(), Payload.size());
+    out.close();
+    if (!out.good() || std::rename(tmp_path.c_str(), path.c_str())) {
+      std::remove(tmp_path.c_str());
+      throw invalid_template_cache()
+          << "[ERROR]: Failed to write template cache file: " << path;
+    }
+  }
+};
+
+/// Template contents written by TemplateCacheWriter, mapped read-only so that
+/// loading only reads the record headers, template contents are paged in as
+/// they are used, and every process on a node reading the same file shares
+/// the same physical pages.
+///
+/// Calculators loaded from a cache read their contents in place and must
+/// hold the shared_ptr for as long as they are used.
+class TemplateCache {
+  std::string Path;
+  void *Mapping;
+  size_t MappingBytes;
+  std::string ConfigMD5;
+  uint64_t PayloadChecksum;
+  std::map<std::string, std::vector<TemplateCacheArray>> Records;
+
+  explicit TemplateCache(std::string const &path)
+      : Path(path), Mapping(MAP_FAILED), MappingBytes(0), PayloadChecksum(0) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw invalid_template_cache()
+          << "[ERROR]: Failed to open template cache file: " << path;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+      MappingBytes = size_t(st.st_size);
+    }
+    if (MappingBytes >= sizeof(template_cache::FileHeader)) {
+      Mapping = mmap(nullptr, MappingBytes, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (Mapping == MAP_FAILED) {
+      throw invalid_template_cache()
+          << "[ERROR]: Failed to map template cache file: " << path;
+    }
+
+    try {
+      Index();
+    } catch (...) {
+      munmap(Mapping, MappingBytes);
+      throw;
+    }
+  }
+
+  void Index() {
+    char const *base = static_cast<char const *>(Mapping);
+    template_cache::FileHeader hdr;
+    std::memcpy(&hdr, base, sizeof(hdr));
+    if (std::memcmp(hdr.Magic, template_cache::Magic, sizeof(hdr.Magic)) ||
+        (hdr.Version != template_cache::Version)) {
+      throw invalid_template_cache()
+          << "[ERROR]: " << Path
+          << " is not a version " << template_cache::Version
+          << " template cache file, rebuild it with BuildTemplateCacheNuSyst.";
+    }
+    char const *payload = base + sizeof(hdr);
+    if (hdr.PayloadBytes != (MappingBytes - sizeof(hdr))) {
+      throw invalid_template_cache()
+          << "[ERROR]: Template cache file " << Path << " is truncated.";
+    }
+    ConfigMD5.assign(hdr.ConfigMD5,
+                     strnlen(hdr.ConfigMD5, sizeof(hdr.ConfigMD5)));
+    PayloadChecksum = hdr.PayloadChecksum;
+    char const *end = payload + hdr.PayloadBytes;
+
+    // The payload checksum is only verified on request, as that would read
+    // every page of the file, so the record layout is bounds checked here.
+    // Counts are compared with the number of elements that fit, as sizes read
+    // from a corrupt file may overflow when multiplied out.
+    auto check = [&](uint64_t n, size_t elem_size, char const *p) {
+      if (n > (size_t(end - p) / elem_size)) {
+        throw invalid_template_cache()
+            << "[ERROR]: Template cache file " << Path << " is malformed.";
+      }
+    };
+
+    char const *rec = payload;
+    for (uint32_t r_it = 0; r_it < hdr.NRecords; ++r_it) {
+      template_cache::RecordHeader rhdr;
+      check(1, sizeof(rhdr), rec);
+      std::memcpy(&rhdr, rec, sizeof(rhdr));
+      rec += sizeof(rhdr);
+      check(rhdr.KeyLength, 1, rec);
+      check(template_cache::Padded(rhdr.KeyLength), 1, rec);
+      std::string key(rec, rhdr.KeyLength);
+      rec += template_cache::Padded(rhdr.KeyLength);
+      check(rhdr.NArrays, sizeof(uint64_t), rec);
+      uint64_t const *sizes = reinterpret_cast<uint64_t const *>(rec);
+      rec += rhdr.NArrays * sizeof(uint64_t);
+
+      std::vector<TemplateCacheArray> &arrays = Records[key];
+      for (uint64_t a_it = 0; a_it < rhdr.NArrays; ++a_it) {
+        check(sizes[a_it], sizeof(double), rec);
+        arrays.push_back({reinterpret_cast<double const *>(rec), sizes[a_it]});
+        rec += sizes[a_it] * sizeof(double);
+      }
+    }
+  }
+
+  struct Active {
+    std::shared_ptr<TemplateCache const> cache;
+  };
+  static Active &GetActiveState() {
+    static thread_local Active active;
+    return active;
+  }
+
+public:
+  TemplateCache(TemplateCache const &) = delete;
+  TemplateCache &operator=(TemplateCache const &) = delete;
+  ~TemplateCache() { munmap(Mapping, MappingBytes); }
+
+  /// Each file is only mapped once per process, however many calculators and
+  /// response_helper replicas load from it.
+  static std::shared_ptr<TemplateCache const> Open(std::string const &path) {
+    static std::mutex m;
+    static std::map<std::string, std::weak_ptr<TemplateCache const>> open;
+    std::lock_guard<std::mutex> lock(m);
+    std::shared_ptr<TemplateCache const> cache = open[path].lock();
+    if (!cache) {
+      cache = std::shared_ptr<TemplateCache const>(new TemplateCache(path));
+      open[path] = cache;
+    }
+    return cache;
+  }
+
+  /// The cache that providers being set up on this thread should load their
+  /// templates from, or null, see ScopedTemplateCache.
+  static std::shared_ptr<TemplateCache const> GetActive() {
+    return GetActiveState().cache;
+  }
+
+  std::string const &GetPath() const { return Path; }
+  std::string const &GetConfigMD5() const { return ConfigMD5; }
+  size_t GetNRecords() const { return Records.size(); }
+
+  /// Throws if the payload does not match the checksum written with it.
+  ///
+  /// \note Reads the whole file, so is not done by Open.
+  void VerifyChecksum() const {
+    size_t HeaderBytes = sizeof(template_cache::FileHeader);
+    char const *payload = static_cast<char const *>(Mapping) + HeaderBytes;
+    if (template_cache::Checksum(payload, MappingBytes - HeaderBytes) !=
+        PayloadChecksum) {
+      throw invalid_template_cache()
+          << "[ERROR]: Template cache file " << Path
+          << " is corrupt, rebuild it with BuildTemplateCacheNuSyst.";
+    }
+  }
+
+  bool HasRecord(std::string const &key) const { return Records.count(key); }
+
+  std::vector<TemplateCacheArray> const &
+  GetRecord(std::string const &key) const {
+    auto rec_it = Records.find(key);
+    if (rec_it == Records.end()) {
+      throw invalid_template_cache()
+          << "[ERROR]: Template cache file " << Path
+          << " contains no record for " << key
+          << ", rebuild it with BuildTemplateCacheNuSyst.";
+    }
+    return rec_it->second;
+  }
+
+  friend class ScopedTemplateCache;
+};
+
+/// Makes cache the active TemplateCache on this thread for the lifetime of
+/// the guard, so that providers set up meanwhile load from it rather than
+/// from their input ROOT files.
+class ScopedTemplateCache {
+  std::shared_ptr<TemplateCache const> previous;
+
+public:
+  explicit ScopedTemplateCache(std::shared_ptr<TemplateCache const> cache)
+      : previous(TemplateCache::GetActiveState().cache) {
+    TemplateCache::GetActiveState().cache = std::move(cache);
+  }
+
+  ScopedTemplateCache(ScopedTemplateCache const &) = delete;
+  ScopedTemplateCache &operator=(ScopedTemplateCache const &) = delete;
+
+  ~ScopedTemplateCache() {
+    TemplateCache::GetActiveState().cache = std::move(previous);
+  }
+};
+
+} // namespace nusyst
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "nusystematics/utility/response_helper.hh"
+
+#include "Framework/EventGen/EventRecord.h"
+
+#include "TROOT.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace nusyst {
+
+NEW_SYSTTOOLS_EXCEPT(parallel_response_helper_invalid_configuration);
+
+/// Per-worker deques of event ranges. Workers pop work from the front of
+/// their own deque and steal from the back of their neighbours' once they
+/// run dry.
+class work_stealing_queue {
+public:
+  typedef std::pair<size_t, size_t> range_t;
+
+private:
+  struct worker_deque {
+    std::mutex m;
+    std::deque<range_t> ranges;
+  };
+  std::vector<std::unique_ptr<worker_deque>> deques;
+
+public:
+  work_stealing_queue(size_t NWorkers) {
+    for (size_t w_it = 0; w_it < NWorkers; ++w_it) {
+      deques.emplace_back(std::make_unique<worker_deque>());
+    }
+  }
+
+  /// Splits [0, NItems) into chunks of ChunkSize and deals contiguous runs of
+  /// chunks out to the workers.
+  void Fill(size_t NItems, size_t ChunkSize) {
+    size_t NChunks = (NItems + ChunkSize - 1) / ChunkSize;
+    size_t NPerWorker = (NChunks + deques.size() - 1) / deques.size();
+    for (size_t c_it = 0; c_it < NChunks; ++c_it) {
+      size_t begin = c_it * ChunkSize;
+      size_t end = std::min(NItems, begin + ChunkSize);
+      worker_deque &wd = *deques[c_it / NPerWorker];
+      std::lock_guard<std::mutex> lock(wd.m);
+      wd.ranges.emplace_back(begin, end);
+    }
+  }
+
+  bool Pop(size_t worker, range_t &r) {
+    {
+      worker_deque &wd = *deques[worker];
+      std::lock_guard<std::mutex> lock(wd.m);
+      if (wd.ranges.size()) {
+        r = wd.ranges.front();
+        wd.ranges.pop_front();
+        return true;
+      }
+    }
+    for (size_t v_it = 1; v_it < deques.size(); ++v_it) {
+      worker_deque &victim = *deques[(worker + v_it) % deques.size()];
+      std::lock_guard<std::mutex> lock(victim.m);
+      if (victim.ranges.size()) {
+        r = victim.ranges.back();
+        victim.ranges.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+/// Drives one independent response_helper, and so one independent set of
+/// IGENIESystProvider_tool instances, per worker thread.
+///
+/// All replicas are configured from the same
+/// generated_systematic_provider_configuration, so the responses for each
+/// event are identical to those of the serial response_helper. Results are
+/// always returned in input order. More than one thread is refused if any
+/// configured provider does not support parallel replicas.
+class parallel_response_helper {
+
+  std::vector<std::unique_ptr<response_helper>> replicas;
+  std::vector<EventResponseArena> arenas;
+  std::vector<std::thread> workers;
+
+  size_t ChunkSize;
+
+  // Current batch, only touched by the workers between a StartBatch
+  // notification and the final FinishWork call.
+  std::vector<std::unique_ptr<genie::EventRecord>> const *batch_events;
+  std::vector<systtools::event_unit_response_w_cv_t> *batch_responses;
+  work_stealing_queue queue;
+
+  std::mutex m;
+  std::condition_variable batch_cv;
+  std::condition_variable done_cv;
+  size_t batch_generation;
+  size_t NWorkersBusy;
+  bool shutdown;
+  std::exception_ptr worker_exception;
+
+  void WorkerLoop(size_t worker) {
+    size_t seen_generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m);
+        batch_cv.wait(lock, [&]() {
+          return shutdown || (batch_generation != seen_generation);
+        });
+        if (shutdown) {
+          return;
+        }
+        seen_generation = batch_generation;
+      }
+
+      try {
+        work_stealing_queue::range_t r;
+        while (queue.Pop(worker, r)) {
+          for (size_t ev_it = r.first; ev_it < r.second; ++ev_it) {
+            replicas[worker]->FillEventVariationAndCVResponses(
+                *(*batch_events)[ev_it], arenas[worker]);
+            (*batch_responses)[ev_it] =
+                arenas[worker].GetEventVariationAndCVResponse();
+          }
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m);
+        if (!worker_exception) {
+          worker_exception = std::current_exception();
+        }
+        // Drain the queue so that the other workers finish promptly.
+        work_stealing_queue::range_t r;
+        while (queue.Pop(worker, r)) {
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(m);
+      if (!(--NWorkersBusy)) {
+        done_cv.notify_one();
+      }
+    }
+  }
+
+public:
+  parallel_response_helper(std::string const &fhicl_config_filename,
+                           size_t NThreads, size_t chunk_size = 16)
+      : ChunkSize(chunk_size ? chunk_size : 1), batch_events(nullptr),
+        batch_responses(nullptr), queue(NThreads ? NThreads : 1),
+        batch_generation(0), NWorkersBusy(0), shutdown(false) {
+
+    if (!NThreads) {
+      throw parallel_response_helper_invalid_configuration()
+          << "[ERROR]: Expected to be asked for at least one worker thread.";
+    }
+
+    if (NThreads > 1) {
+      ROOT::EnableThreadSafety();
+    }
+
+    // Providers are constructed serially as GENIE and ROOT singletons are
+    // first touched during setup.
+    for (size_t t_it = 0; t_it < NThreads; ++t_it) {
+      replicas.emplace_back(
+          std::make_unique<response_helper>(fhicl_config_filename));
+      arenas.emplace_back(replicas.back()->MakeEventResponseArena());
+
+      if ((NThreads > 1) && !t_it) {
+        for (auto &sp : replicas.front()->GetSystProvider()) {
+          if (!sp->SupportsParallelReplicas()) {
+            throw parallel_response_helper_invalid_configuration()
+                << "[ERROR]: Systematic provider "
+                << std::quoted(sp->GetFullyQualifiedName())
+                << " does not support parallel replicas as configured in "
+                << std::quoted(fhicl_config_filename)
+                << ", use a single thread.";
+          }
+        }
+      }
+    }
+
+    for (size_t t_it = 0; t_it < NThreads; ++t_it) {
+      workers.emplace_back(&parallel_response_helper::WorkerLoop, this, t_it);
+    }
+  }
+
+  parallel_response_helper(parallel_response_helper const &) = delete;
+  parallel_response_helper &
+  operator=(parallel_response_helper const &) = delete;
+
+  ~parallel_response_helper() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      shutdown = true;
+    }
+    batch_cv.notify_all();
+    for (auto &w : workers) {
+      w.join();
+    }
+  }
+
+  size_t GetNThreads() const { return replicas.size(); }
+
+  /// All replicas share identical parameter headers, so the first one can be
+  /// used to describe the configured parameters.
+  response_helper const &GetHeaderHelper() const { return *replicas.front(); }
+
+  /// Has every replica write its providers' diagnostics to dir.
+  ///
+  /// \note Must not be called while a batch is being processed.
+  void WriteDiagnostics(TDirectory *dir) {
+    for (auto &replica : replicas) {
+      replica->WriteDiagnostics(dir);
+    }
+  }
+
+  /// Combines the per-thread profiles, null unless profiling was enabled in
+  /// the configuration.
+  ///
+  /// \note Must not be called while a batch is being processed.
+  std::unique_ptr<ResponseProfiler> GetMergedProfiler() const {
+    if (!replicas.front()->GetProfiler()) {
+      return nullptr;
+    }
+    std::unique_ptr<ResponseProfiler> merged =
+        std::make_unique<ResponseProfiler>(*replicas.front()->GetProfiler());
+    for (size_t t_it = 1; t_it < replicas.size(); ++t_it) {
+      merged->Merge(*replicas[t_it]->GetProfiler());
+    }
+    return merged;
+  }
+
+  /// Calculates the variation and CV responses for a batch of events, the
+  /// i-th response corresponds to the i-th event.
+  std::vector<systtools::event_unit_response_w_cv_t>
+  GetEventVariationAndCVResponses(
+      std::vector<std::unique_ptr<genie::EventRecord>> const &gheps) {
+
+    std::vector<systtools::event_unit_response_w_cv_t> responses(gheps.size());
+    if (!gheps.size()) {
+      return responses;
+    }
+
+    std::unique_lock<std::mutex> lock(m);
+    batch_events = &gheps;
+    batch_responses = &responses;
+    worker_exception = nullptr;
+    queue.Fill(gheps.size(), ChunkSize);
+    NWorkersBusy = workers.size();
+    batch_generation++;
+    batch_cv.notify_all();
+
+    done_cv.wait(lock, [&]() { return !NWorkersBusy; });
+    batch_events = nullptr;
+    batch_responses = nullptr;
+
+    if (worker_exception) {
+      std::rethrow_exception(worker_exception);
+    }
+    return responses;
+  }
+};
+
+} // namespace nusyst
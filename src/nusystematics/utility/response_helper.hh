@@ -1,21 +1,30 @@
 #pragma once
 
+#include "nusystematics/interface/CVResponseTable.hh"
 #include "nusystematics/interface/IGENIESystProvider_tool.hh"
+#include "nusystematics/interface/ParameterSlots.hh"
+#include "nusystematics/utility/EventKinematics.hh"
 #include "nusystematics/utility/make_instance.hh"
+#include "nusystematics/utility/PerfCounters.hh"
+#include "nusystematics/utility/ResponseProfiler.hh"
+#include "nusystematics/utility/ResponseTracer.hh"
+#include "nusystematics/utility/TemplateCache.hh"
 
 #include "systematicstools/interface/SystParamHeader.hh"
 
 #include "systematicstools/interpreters/ParamHeaderHelper.hh"
 
 #include "systematicstools/utility/ParameterAndProviderConfigurationUtility.hh"
+#include "systematicstools/utility/md5.hh"
 
 #include "Framework/EventGen/EventRecord.h"
 
 #include "TFile.h"
 #include "TTree.h"
 
-#include <chrono>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace nusyst {
 
@@ -24,21 +33,211 @@ NEW_SYSTTOOLS_EXCEPT(response_helper_found_no_parameters);
 class response_helper : public systtools::ParamHeaderHelper {
 
   size_t NEvsProcessed;
-  std::map<simb_mode_copy, std::map<size_t, std::tuple<double, double, size_t>>>
-      ProfileStats;
+  std::unique_ptr<ResponseProfiler> profiler;
+  // Opened on the first profiled event, so that they count the thread that
+  // calculates the responses.
+  std::unique_ptr<PerfCounters> counters;
 
 private:
   constexpr static size_t Order = 5;
   constexpr static size_t NCoeffs = Order + 1;
 
+  bool ProfilingEnabled;
+  bool PerfCountersEnabled;
   size_t ProfilerRate;
 
   std::string config_file;
   std::vector<std::unique_ptr<IGENIESystProvider_tool>> syst_providers;
 
+  // Dense slot for every configured parameter with a response, in
+  // GetParameters order.
+  ParameterSlots Slots;
+  // CV handling for every slot, used to separate the CV response from batch
+  // responses.
+  CVResponseTable CVTable;
+
+  std::vector<ResponseTracer::name_id_t> ProviderTraceNames;
+  ResponseTracer::name_id_t KinematicsTraceName;
+  ResponseTracer::name_id_t SeparateCVTraceName;
+
+  EventKinematics GetEventKinematics(genie::EventRecord const &GenieGHep) {
+    TraceSpan span(KinematicsTraceName);
+    return BuildEventKinematics(GenieGHep);
+  }
+
+  void InternTraceNames() {
+    ResponseTracer &tracer = ResponseTracer::Get();
+    ProviderTraceNames.clear();
+    for (auto &sp : syst_providers) {
+      ProviderTraceNames.push_back(tracer.Intern(sp->GetFullyQualifiedName()));
+    }
+    KinematicsTraceName = tracer.Intern("BuildEventKinematics");
+    SeparateCVTraceName = tracer.Intern("SeparateCVResponses");
+  }
+
+  // Providers to visit for each [mode][current][flavour] combination, in
+  // configuration order. The flag is false for providers that do not apply
+  // to the combination and so only contribute their cached default response.
+  typedef std::vector<std::pair<size_t, bool>> dispatch_list_t;
+  std::vector<dispatch_list_t> DispatchTable;
+  std::vector<systtools::event_unit_response_t> DefaultResponses;
+  std::vector<systtools::event_unit_response_w_cv_t> DefaultCVResponses;
+
+  static size_t DispatchIndex(size_t mode_idx, size_t current_idx,
+                              size_t flavour_idx) {
+    return (mode_idx * EventApplicability::NCurrents + current_idx) *
+               EventApplicability::NFlavours +
+           flavour_idx;
+  }
+
+  void BuildDispatchTable() {
+    DefaultResponses.clear();
+    DefaultCVResponses.clear();
+    for (auto &sp : syst_providers) {
+      if (sp->GetEventApplicability().GetOutsideResponse() ==
+          EventApplicability::outside_response_t::kDefault) {
+        DefaultResponses.push_back(sp->GetDefaultEventResponse());
+      } else {
+        DefaultResponses.emplace_back();
+      }
+      DefaultCVResponses.push_back(
+          sp->GetVariationAndCVResponse(DefaultResponses.back()));
+    }
+
+    DispatchTable.assign(EventApplicability::NModes *
+                             EventApplicability::NCurrents *
+                             EventApplicability::NFlavours,
+                         dispatch_list_t());
+    for (size_t m_it = 0; m_it < EventApplicability::NModes; ++m_it) {
+      for (size_t c_it = 0; c_it < EventApplicability::NCurrents; ++c_it) {
+        for (size_t f_it = 0; f_it < EventApplicability::NFlavours; ++f_it) {
+          dispatch_list_t &dl = DispatchTable[DispatchIndex(m_it, c_it, f_it)];
+          for (size_t sp_it = 0; sp_it < syst_providers.size(); ++sp_it) {
+            bool applies =
+                syst_providers[sp_it]->GetEventApplicability().Applies(
+                    m_it, c_it, f_it);
+            if (applies || DefaultResponses[sp_it].size()) {
+              dl.emplace_back(sp_it, applies);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  dispatch_list_t const &GetDispatchList(EventKinematics const &kin) const {
+    return DispatchTable[DispatchIndex(
+        EventApplicability::ModeIndex(kin.mode),
+        EventApplicability::CurrentIndex(kin.IsCC, kin.IsNC),
+        EventApplicability::FlavourIndex(kin.nu_pdg))];
+  }
+
+  void SetupProfiler() {
+    profiler.reset();
+    for (auto &sp : syst_providers) {
+      sp->SetResponseProfiler(nullptr);
+    }
+    if (!ProfilingEnabled) {
+      return;
+    }
+    profiler = std::make_unique<ResponseProfiler>();
+    for (auto &sp : syst_providers) {
+      size_t sp_idx = profiler->AddProvider(sp->GetFullyQualifiedName());
+      for (systtools::SystParamHeader const &hdr : sp->GetSystMetaData()) {
+        if (!hdr.isResponselessParam) {
+          profiler->AddParameter(sp_idx, hdr.systParamId, hdr.prettyName);
+        }
+      }
+      sp->SetResponseProfiler(profiler.get());
+    }
+  }
+
+  PerfCounters const *GetPerfCounters() {
+    if (!PerfCountersEnabled) {
+      return nullptr;
+    }
+    if (!counters) {
+      counters = std::make_unique<PerfCounters>();
+      if (!counters->IsAvailable()) {
+        std::cout << "[WARN]: Hardware performance counters are unavailable ("
+                  << counters->GetError()
+                  << "), only latencies will be profiled." << std::endl;
+        counters.reset();
+        PerfCountersEnabled = false;
+      }
+    }
+    return counters.get();
+  }
+
+  struct ProviderCallProfile {
+    ResponseProfiler::clock::time_point start;
+    PerfCounters::values_t counts;
+    bool counted;
+  };
+
+  void StartProviderCall(ProviderCallProfile &pcp) {
+    if (!profiler) {
+      return;
+    }
+    PerfCounters const *pc = GetPerfCounters();
+    pcp.start = ResponseProfiler::clock::now();
+    pcp.counted = pc && pc->Read(pcp.counts);
+  }
+
+  void EndProviderCall(ProviderCallProfile const &pcp, size_t sp_it,
+                       size_t mode_idx) {
+    PerfCounters::values_t end_counts;
+    if (pcp.counted && counters->Read(end_counts)) {
+      profiler->RecordProviderCounters(sp_it, mode_idx, pcp.counts,
+                                       end_counts);
+    }
+    profiler->RecordProvider(sp_it, mode_idx, pcp.start);
+  }
+
+  void ReportProfile() {
+    if (!profiler || !ProfilerRate || !NEvsProcessed ||
+        (NEvsProcessed % ProfilerRate)) {
+      return;
+    }
+    std::cout << std::endl
+              << "[PROFILE]: Event number = " << NEvsProcessed << std::endl;
+    profiler->Print(std::cout);
+  }
+
+  void FillEventResponses(genie::EventRecord const &GenieGHep,
+                          EventKinematics const &kin,
+                          EventResponseArena &arena) {
+    for (auto const &sp_app : GetDispatchList(kin)) {
+      size_t sp_it = sp_app.first;
+      if (!sp_app.second) {
+        arena.Add(DefaultResponses[sp_it]);
+        continue;
+      }
+
+      ProviderCallProfile pcp;
+      StartProviderCall(pcp);
+
+      size_t NFilled = arena.GetNFilled();
+      {
+        TraceSpan span(ProviderTraceNames[sp_it]);
+        syst_providers[sp_it]->FillEventResponse(GenieGHep, kin, arena);
+      }
+
+      if (profiler && (arena.GetNFilled() != NFilled)) {
+        EndProviderCall(pcp, sp_it, EventApplicability::ModeIndex(kin.mode));
+      }
+    }
+  }
+
 public:
-  response_helper() : NEvsProcessed(0), ProfilerRate(0) {}
-  response_helper(std::string const &fhicl_config_filename) : NEvsProcessed(0) {
+  response_helper()
+      : NEvsProcessed(0), ProfilingEnabled(false),
+        PerfCountersEnabled(false), ProfilerRate(0) {
+    InternTraceNames();
+  }
+  response_helper(std::string const &fhicl_config_filename)
+      : NEvsProcessed(0), ProfilingEnabled(false),
+        PerfCountersEnabled(false), ProfilerRate(0) {
     LoadConfiguration(fhicl_config_filename);
   }
 
@@ -65,6 +264,19 @@ public:
     }
     
     SetHeaders(configuredParameterHeaders);
+
+    Slots = ParameterSlots();
+    CVTable = CVResponseTable();
+    for (systtools::paramId_t pid : GetParameters()) {
+      if (!GetHeader(pid).isResponselessParam) {
+        Slots.Add(pid);
+        CVTable.AddParameter(GetHeader(pid));
+      }
+    }
+
+    BuildDispatchTable();
+    SetupProfiler();
+    InternTraceNames();
   }
 
   void LoadConfiguration(std::string const &fhicl_config_filename) {
@@ -74,18 +286,86 @@ public:
     std::unique_ptr<cet::filepath_maker> fm = std::make_unique<cet::filepath_maker>();
     fhicl::ParameterSet ps = fhicl::ParameterSet::make(config_file, *fm);
 
-    LoadProvidersAndHeaders(ps.get<fhicl::ParameterSet>(
-        "generated_systematic_provider_configuration"));
-
+    // ProfileRate is the number of events between printed summaries,
+    // profiling can be enabled without them to only export the final
+    // summary.
     ProfilerRate = ps.get<size_t>("ProfileRate", 0);
+    // Hardware counters are reported alongside the latencies, so imply
+    // profiling.
+    PerfCountersEnabled = ps.get<bool>("PerfCounters", false);
+    ProfilingEnabled =
+        ps.get<bool>("Profile", ProfilerRate > 0) || PerfCountersEnabled;
+
+    // Spans are kept in a per-thread ring buffer of TraceBufferSize entries,
+    // the owning application is responsible for writing them out.
+    if (ps.get<bool>("Trace", false)) {
+      ResponseTracer::Get().Enable(
+          ps.get<size_t>("TraceBufferSize", size_t(1) << 20));
+    }
+
+    fhicl::ParameterSet const &provider_ps = ps.get<fhicl::ParameterSet>(
+        "generated_systematic_provider_configuration");
+
+    // Templates written by BuildTemplateCacheNuSyst for exactly this provider
+    // configuration are loaded from the cache rather than from ROOT files.
+    std::shared_ptr<TemplateCache const> cache;
+    std::string cache_file = ps.get<std::string>("TemplateCacheFile", "");
+    if (cache_file.size()) {
+      cache = TemplateCache::Open(cache_file);
+      // Reads the whole file, so is only worth it when debugging.
+      if (ps.get<bool>("TemplateCacheVerifyChecksum", false)) {
+        cache->VerifyChecksum();
+      }
+      std::string config_md5 = systtools::md5(provider_ps.to_compact_string());
+      if (cache->GetConfigMD5() != config_md5) {
+        throw invalid_template_cache()
+            << "[ERROR]: Template cache file " << std::quoted(cache_file)
+            << " was built for the provider configuration with md5: "
+            << std::quoted(cache->GetConfigMD5()) << ", but "
+            << std::quoted(config_file) << " has md5: "
+            << std::quoted(config_md5)
+            << ", rebuild it with BuildTemplateCacheNuSyst.";
+      }
+    }
+    ScopedTemplateCache use_cache(cache);
+
+    LoadProvidersAndHeaders(provider_ps);
+  }
+
+  /// Null unless profiling was enabled in the configuration.
+  ResponseProfiler const *GetProfiler() const { return profiler.get(); }
+
+  /// The parameters whose responses any provider may emulate, see
+  /// IGENIESystProvider_tool::GetEmulatedParameters.
+  std::vector<systtools::paramId_t> GetEmulatedParameters() const {
+    std::vector<systtools::paramId_t> pids;
+    for (auto const &sp : syst_providers) {
+      std::vector<systtools::paramId_t> sp_pids = sp->GetEmulatedParameters();
+      pids.insert(pids.end(), sp_pids.begin(), sp_pids.end());
+    }
+    return pids;
+  }
+
+  /// Has every provider write its diagnostics to dir.
+  void WriteDiagnostics(TDirectory *dir) {
+    for (auto &sp : syst_providers) {
+      sp->WriteDiagnostics(dir);
+    }
   }
 
   systtools::event_unit_response_t
   GetEventResponses(genie::EventRecord const &GenieGHep) {
     systtools::event_unit_response_t response;
-    for (auto &sp : syst_providers) {
+    EventKinematics const kin = GetEventKinematics(GenieGHep);
+    for (auto const &sp_app : GetDispatchList(kin)) {
+      if (!sp_app.second) {
+        response.insert(response.end(),
+                        DefaultResponses[sp_app.first].begin(),
+                        DefaultResponses[sp_app.first].end());
+        continue;
+      }
       systtools::event_unit_response_t prov_response =
-          sp->GetEventResponse(GenieGHep);
+          syst_providers[sp_app.first]->GetEventResponse(GenieGHep, kin);
       for (auto &&er : prov_response) {
         response.push_back(std::move(er));
       }
@@ -93,6 +373,61 @@ public:
     return response;
   }
 
+  /// The slot assigned to each configured parameter when the providers were
+  /// loaded. Response containers made by this helper use the same slots.
+  ParameterSlots const &GetParameterSlots() const { return Slots; }
+
+  /// Builds a response block with a row for every configured parameter.
+  EventResponseBlock MakeEventResponseBlock() const {
+    EventResponseBlock block;
+    for (size_t slot = 0; slot < Slots.size(); ++slot) {
+      block.AddParameter(GetHeader(Slots.GetParameterId(slot)));
+    }
+    return block;
+  }
+
+  /// Calculates the responses of all configured providers to a batch of
+  /// events. block should have been built by MakeEventResponseBlock.
+  void
+  GetEventResponses(std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+                    EventResponseBlock &block) {
+    block.Reset(gheps.size());
+    for (auto &sp : syst_providers) {
+      sp->GetEventResponses(gheps, block);
+    }
+  }
+
+  /// As GetEventVariationAndCVResponse for a batch of events, using the
+  /// batched provider responses. The i-th response corresponds to the i-th
+  /// event. block should have been built by MakeEventResponseBlock.
+  std::vector<systtools::event_unit_response_w_cv_t>
+  GetEventVariationAndCVResponses(
+      std::vector<std::unique_ptr<genie::EventRecord>> const &gheps,
+      EventResponseBlock &block) {
+    GetEventResponses(gheps, block);
+
+    std::vector<systtools::event_unit_response_w_cv_t> responses(gheps.size());
+    for (size_t ev_it = 0; ev_it < gheps.size(); ++ev_it) {
+      for (size_t p_it = 0; p_it < block.GetNParameters(); ++p_it) {
+        if (!block.IsHandled(p_it, ev_it)) {
+          continue;
+        }
+        systtools::paramId_t pid = block.GetParameterId(p_it);
+        ParamCVInfo const &info = CVTable.GetInfo(CVTable.GetIndex(pid));
+
+        std::vector<double> resp(info.NVariations);
+        for (size_t v_it = 0; v_it < info.NVariations; ++v_it) {
+          resp[v_it] = block.At(p_it, v_it, ev_it);
+        }
+        double CVResp = SeparateCVResponse(info, resp.data());
+        responses[ev_it].push_back({pid, CVResp, std::move(resp)});
+      }
+    }
+    NEvsProcessed += gheps.size();
+
+    return responses;
+  }
+
   systtools::event_unit_response_t
   GetEventResponses(genie::EventRecord const &GenieGHep,
                     systtools::paramId_t i) {
@@ -111,71 +446,78 @@ public:
   GetEventVariationAndCVResponse(genie::EventRecord const &GenieGHep) {
     systtools::event_unit_response_w_cv_t response;
 
-    simb_mode_copy mode = GetSimbMode(GenieGHep);
-
-    for (size_t sp_it = 0; sp_it < syst_providers.size(); ++sp_it) {
+    // Extracted once and shared by all providers.
+    EventKinematics const kin = GetEventKinematics(GenieGHep);
+    size_t mode_idx = EventApplicability::ModeIndex(kin.mode);
+
+    // Providers that cannot respond to this event are not called at all.
+    for (auto const &sp_app : GetDispatchList(kin)) {
+      size_t sp_it = sp_app.first;
+      if (!sp_app.second) {
+        response.insert(response.end(), DefaultCVResponses[sp_it].begin(),
+                        DefaultCVResponses[sp_it].end());
+        continue;
+      }
       std::unique_ptr<IGENIESystProvider_tool> const &sp =
           syst_providers[sp_it];
 
-      std::chrono::high_resolution_clock::time_point start;
-      if (ProfilerRate) {
-        start = std::chrono::high_resolution_clock::now();
-      }
+      ProviderCallProfile pcp;
+      StartProviderCall(pcp);
 
-      systtools::event_unit_response_w_cv_t prov_response =
-          sp->GetEventVariationAndCVResponse(GenieGHep);
-
-      if (ProfilerRate && prov_response.size()) {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto diff_ms =
-            std::chrono::duration_cast<std::chrono::microseconds>(end - start)
-                .count();
-
-        if (!ProfileStats[mode].count(sp_it)) {
-          ProfileStats[mode][sp_it] = {0, 0, 0};
-        }
-
-        std::get<2>(ProfileStats[mode][sp_it])++;
-
-        double delta = diff_ms - std::get<0>(ProfileStats[mode][sp_it]);
-
-        std::get<0>(ProfileStats[mode][sp_it]) +=
-            delta / std::get<2>(ProfileStats[mode][sp_it]);
+      systtools::event_unit_response_w_cv_t prov_response;
+      {
+        TraceSpan span(ProviderTraceNames[sp_it]);
+        prov_response = sp->GetEventVariationAndCVResponse(GenieGHep, kin);
+      }
 
-        std::get<1>(ProfileStats[mode][sp_it]) +=
-            delta * (diff_ms - std::get<0>(ProfileStats[mode][sp_it]));
+      if (profiler && prov_response.size()) {
+        EndProviderCall(pcp, sp_it, mode_idx);
       }
       for (auto &&er : prov_response) {
         response.push_back(std::move(er));
       }
     }
 
-    if (ProfilerRate && NEvsProcessed && !(NEvsProcessed % ProfilerRate)) {
-      std::cout << std::endl
-                << "[PROFILE]: Event number = " << NEvsProcessed << std::endl;
-      for (size_t sp_it = 0; sp_it < syst_providers.size(); ++sp_it) {
-        std::cout << "\tSystProvider: "
-                  << syst_providers[sp_it]->GetFullyQualifiedName()
-                  << std::endl;
-        for (auto const &m : ProfileStats) {
-          if (!m.second.count(sp_it) || (std::get<2>(m.second.at(sp_it)) < 2)) {
-            continue;
-          }
-          std::cout << "\t\tMode: " << tostr(m.first)
-                    << ", NEvs = " << std::get<2>(m.second.at(sp_it))
-                    << ", mean: " << std::get<0>(m.second.at(sp_it))
-                    << " us, stddev: "
-                    << sqrt(std::get<1>(m.second.at(sp_it)) /
-                            (std::get<2>(m.second.at(sp_it)) - 1))
-                    << " us." << std::endl;
-        }
-      }
-    }
+    ReportProfile();
     NEvsProcessed++;
 
     return response;
   }
 
+  /// Builds a response arena with a slot for every configured parameter.
+  EventResponseArena MakeEventResponseArena() const {
+    EventResponseArena arena;
+    for (size_t slot = 0; slot < Slots.size(); ++slot) {
+      arena.AddParameter(GetHeader(Slots.GetParameterId(slot)));
+    }
+    return arena;
+  }
+
+  /// Calculates the responses of all configured providers to an event in
+  /// place. arena should have been built by MakeEventResponseArena.
+  void FillEventResponses(genie::EventRecord const &GenieGHep,
+                          EventResponseArena &arena) {
+    arena.Reset();
+    EventKinematics const kin = GetEventKinematics(GenieGHep);
+    FillEventResponses(GenieGHep, kin, arena);
+  }
+
+  /// As GetEventVariationAndCVResponse, but in place. Providers that override
+  /// IGENIESystProvider_tool::FillEventResponse do not allocate.
+  void FillEventVariationAndCVResponses(genie::EventRecord const &GenieGHep,
+                                        EventResponseArena &arena) {
+    arena.Reset();
+    EventKinematics const kin = GetEventKinematics(GenieGHep);
+    FillEventResponses(GenieGHep, kin, arena);
+    {
+      TraceSpan span(SeparateCVTraceName);
+      arena.SeparateCVResponses();
+    }
+
+    ReportProfile();
+    NEvsProcessed++;
+  }
+
   double GetEventWeightResponse(genie::EventRecord const &GenieGHep,
                                 systtools::param_value_list_t const &vals) {
     double weight = 1;